@@ -5,5 +5,8 @@ extern double compute_ex(const double a, const double b, const double t);
 extern double compute_ey(const double a, const double b, const double t);
 extern double compute_curvature(const double a, const double b, const double t);
 extern double find_normal_t(const double a, const double b, const double x_, const double y_);
+extern double find_normal_t_from(const double a, const double b, const double x_, const double y_, const double t_guess);
+extern double compute_signed_dist(const double a, const double b, const double x_, const double y_);
+extern int compute_signed_dists(const double a, const double b, const double x0, const double y0, const double cosine, const double sine, const double y, const int n, const double * restrict xs, double * restrict dists);
 
 #endif // ELLIPSE_H
@@ -25,7 +25,7 @@ typedef struct schedule_t_ {
   double next;
 } schedule_t;
 
-/* ! definition of a structure param_t_ ! 24 !*/
+/* ! definition of a structure param_t_ ! 31 !*/
 struct param_t_ {
   // restart / initialise
   bool load_flow_field;
@@ -50,6 +50,13 @@ struct param_t_ {
   // when to stop, when to write log, etc.
   double timemax, wtimemax;
   schedule_t log, save, stat;
+  // particle-particle collision detection
+  bool collision_cell_list;
+  double collision_skin;
+  // half width of the band around particle surfaces where IBM weights are computed
+  double ibm_band_width;
+  // each process stores only its own particles and ghosts
+  bool particle_ownership;
 };
 
 extern param_t *param_init(void);
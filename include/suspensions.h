@@ -6,6 +6,8 @@
 #include "arrays/suspensions.h"
 
 typedef struct particle_t_ {
+  // index in the whole domain
+  int id;
   // fixed parameters
   // density (ratio), major and minor axes
   double den, a, b;
@@ -30,7 +32,115 @@ typedef struct particle_t_ {
   double cfx[2], cfy[2], ctz[2];
 } particle_t;
 
+// uniform-grid cell list to find collision candidates,
+//   cell sizes are no smaller than the largest diameter of particles plus the skin
+//   so that only the adjacent cells need to be checked
+typedef struct {
+  int ncellx, ncelly;
+  double cellsizex, cellsizey;
+  // first particle in each cell and the next one in the same cell,
+  //   -1 when there is no more
+  int *heads, *nexts;
+} collision_cells_t;
+
+// converged state of the previous contact detection of a pair (or a particle and a wall),
+//   used as the initial guess of the next one
+//   since contacts barely change between iterations and RK stages
+typedef struct {
+  bool is_valid;
+  // parameters of the ellipses whose normals give the equivalent circles,
+  //   centres of the circles are the centres of curvature at t
+  //   and thus recovered from t and the current particle positions
+  double t0, t1;
+} collision_contact_t;
+
+// Verlet list of collision candidates,
+//   pairs whose circumscribed circles are closer than the skin distance,
+//   which is valid until one of the particles moves more than half of the skin
+typedef struct {
+  bool is_built;
+  double skin;
+  // positions with which the list was built
+  double *xs, *ys;
+  // pairs handled by this process,
+  //   partners (> n0) of particle n0 are stored in partners[offsets[n0] : offsets[n0+1]-1]
+  int *offsets;
+  int n_partners, n_partners_max;
+  int *partners;
+  // contact caches of the pairs, contacts[n] is for partners[n]
+  collision_contact_t *contacts;
+  // contact caches of particle-wall collisions, wall_contacts[2*n+wall_index]
+  collision_contact_t *wall_contacts;
+} collision_neighbours_t;
+
+// geometry of a particle at a position,
+//   computed once per evaluation and passed to the per-point kernels
+typedef struct {
+  // major and minor axes, 1/a^2 and 1/b^2
+  double a, b;
+  double inv_a2, inv_b2;
+  // gravity center and rotation angle
+  double x, y, az;
+  // rotation matrix, cos(az) and sin(az)
+  double cosaz, sinaz;
+  // radius of the circumscribed circle
+  double radius;
+  double mass, moment_of_inertia;
+} geometry_t;
+
+// IBM weights on the grid points around a particle (periodic image),
+//   on rows [jmin : jmax] and [imins[j-jmin] : imaxs[j-jmin]] on each row,
+//   and weights at (i, j) are stored in [offsets[j-jmin]+(i-imins[j-jmin])]
+typedef struct {
+  int jmin, jmax;
+  int *imins, *imaxs;
+  int *offsets;
+  int row_capacity, capacity;
+  double *s_weights, *v_weights;
+} stencil_image_t;
+
+// IBM weights of a particle shared by all consumers,
+//   which are reused as long as the particle does not move
+typedef struct {
+  bool is_built;
+  // geometry with which the weights were computed
+  geometry_t geometry;
+  // periodic images -1, 0, +1
+  stencil_image_t images[3];
+} stencil_t;
+
+// periodic images of particles whose stencils intersect the local slab,
+//   (indices[n], periodics[n]) is the n-th pair of particle index and image offset (-1, 0, +1),
+//   which are sorted in ascending order of particle indices
+typedef struct {
+  bool is_built;
+  // positions in y with which the list was built
+  double *ys;
+  int n_entries;
+  int *indices, *periodics;
+} image_list_t;
+
+// distribution of particles among processes,
+//   each particle is owned by the process whose slab contains its center,
+//   and the neighbouring processes keep copies (ghosts) of it if they are within the reach
+typedef struct {
+  // distance from the slab within which particles are kept as ghosts
+  double reach;
+  // particles[0 : n_owned-1] are owned by this process and the rest are ghosts
+  int n_owned;
+  // neighbouring processes in y, without duplication
+  int n_neighbours;
+  int neighbours[2];
+  // owned particles sent to each neighbour as ghosts
+  int n_sends[2];
+  int *sends[2];
+  // ghosts from each neighbour are particles[ghost_offsets[k] : ghost_offsets[k+1]-1]
+  int ghost_offsets[3];
+} ownership_t;
+
 struct suspensions_t_ {
+  // number of particles in the whole domain and in this process
+  int n_particles_total;
   int n_particles;
   particle_t **particles;
   // responses of surface forces and torque on the momentum fields
@@ -38,6 +148,17 @@ struct suspensions_t_ {
   // buffers to communicate Lagrange information
   // whose size is sizeof(double) * 3*n_particles
   double *buf;
+  // IBM weights around each particle
+  stencil_t *stencils;
+  // images of particles handled by this process
+  image_list_t *image_list;
+  // geometries of all particles, used as a buffer
+  geometry_t *geometries;
+  // NULL when all processes have all particles
+  ownership_t *ownership;
+  // collision candidates
+  collision_cells_t *collision_cells;
+  collision_neighbours_t *collision_neighbours;
 };
 
 /* constructor and destructor */
@@ -52,14 +173,23 @@ extern int suspensions_exchange_momentum(const param_t *param, const parallel_t
 extern int suspensions_increment_particles(const param_t *param, const int rkstep, suspensions_t *suspensions, double *residual);
 extern int suspensions_update_momentum_fleid(const param_t *param, const parallel_t *parallel, fluid_t *fluid, const suspensions_t *suspensions);
 extern int suspensions_update_particles(const param_t *param, suspensions_t *suspensions);
+extern int suspensions_migrate_particles(const param_t *param, const parallel_t *parallel, suspensions_t *suspensions);
 
 /* other supportive functions */
 extern int suspensions_decide_loop_size(const int lbound, const int ubound, const double grid_size, const double radius, const double grav_center, int *min, int *max);
+extern int suspensions_decide_row_size(const int lbound, const int ubound, const double grid_size, const double band, const geometry_t *geometry, const double y, int *min, int *max);
 extern double suspensions_compute_volume(const double a, const double b);
 extern double suspensions_compute_mass(const double den, const double a, const double b);
 extern double suspensions_compute_moment_of_inertia(const double den, const double a, const double b);
 
-extern double suspensions_s_weight(const double grid_size, const double pa, const double pb, const double px, const double py, const double paz, const double x, const double y);
-extern double suspensions_v_weight(const double grid_size, const double pa, const double pb, const double px, const double py, const double paz, const double x, const double y);
+extern int suspensions_compute_geometry(const particle_t *p, const double px, const double py, const double paz, geometry_t *geometry);
+extern double suspensions_s_weight(const double grid_size, const geometry_t *geometry, const double x, const double y);
+extern double suspensions_v_weight(const double grid_size, const geometry_t *geometry, const double x, const double y);
+extern int suspensions_compute_weights(const double grid_size, const double band_width, const geometry_t *geometry, const double y, const int n, const double *xs, double *s_ws, double *v_ws);
+extern int suspensions_update_stencil(const param_t *param, const parallel_t *parallel, const geometry_t *geometry, stencil_t *stencil);
+extern int suspensions_sum_over_processes(const suspensions_t *suspensions, const int n_items, double *buf);
+extern int suspensions_copy_to_ghosts(const suspensions_t *suspensions, const int n_items, double *buf);
+extern bool suspensions_is_owner(const parallel_t *parallel, const suspensions_t *suspensions, const int n);
+extern int suspensions_update_image_list(const param_t *param, const parallel_t *parallel, const bool with_increments, const suspensions_t *suspensions);
 
 #endif // SUSPENSIONS_H
@@ -24,13 +24,8 @@ double compute_curvature(const double a, const double b, const double t){
   return num/den;
 }
 
-// find t, with which a vector from (a cos(t), b sin(t)) to (x_, y_)
-//   becomes a normal vector to the ellipse
-// https://blog.chatfield.io/simple-method-for-distance-to-ellipse/
-double find_normal_t(const double a, const double b, const double x_, const double y_){
-  double px = fabs(x_);
-  double py = fabs(y_);
-  double t = 0.25*M_PI;
+static double iterate_normal_t(const double a, const double b, const double px, const double py, double t){
+  // (px, py) is in the 1st quadrant, t is the initial guess
   for(int n = 0; ; n++){
     // point on ellipse
     double x = a*cos(t);
@@ -58,9 +53,175 @@ double find_normal_t(const double a, const double b, const double x_, const doub
       break;
     }
   }
+  return t;
+}
+
+// find t, with which a vector from (a cos(t), b sin(t)) to (x_, y_)
+//   becomes a normal vector to the ellipse
+// https://blog.chatfield.io/simple-method-for-distance-to-ellipse/
+double find_normal_t(const double a, const double b, const double x_, const double y_){
+  double t = iterate_normal_t(a, b, fabs(x_), fabs(y_), 0.25*M_PI);
   // for the other quadrants
   if(x_ < 0.) t = M_PI-t;
   if(y_ < 0.) t =     -t;
   return t;
 }
 
+// same as find_normal_t, but starting from the given t
+//   (e.g., the answer of the previous call) instead of pi/4
+double find_normal_t_from(const double a, const double b, const double x_, const double y_, const double t_guess){
+  // initial guess is mapped to the 1st quadrant
+  double t = atan2(fabs(sin(t_guess)), fabs(cos(t_guess)));
+  t = iterate_normal_t(a, b, fabs(x_), fabs(y_), t);
+  // for the other quadrants
+  if(x_ < 0.) t = M_PI-t;
+  if(y_ < 0.) t =     -t;
+  return t;
+}
+
+// number of iterations of the fixed-cost kernel,
+//   see the benchmark below for the accuracy
+#define NITERS 4
+
+static inline double clamp(const double v){
+  // t is kept in the 1st quadrant,
+  //   lower bound is positive to keep (cos(t), sin(t)) normalisable
+  const double vmin = DBL_EPSILON;
+  const double vmax = 1.;
+  double retval = v;
+  retval = retval < vmin ? vmin : retval;
+  retval = retval > vmax ? vmax : retval;
+  return retval;
+}
+
+static inline double signed_dist_kernel(const double a, const double b, const double x_, const double y_){
+  // same iteration as find_normal_t, but in terms of (cos(t), sin(t)) instead of t
+  //   with a fixed number of iterations, without trigonometric functions and branches
+  // https://github.com/0xfaded/ellipse_demo
+  const double px = fabs(x_);
+  const double py = fabs(y_);
+  const double ab = (a-b)*(a+b);
+  // initial guess: t = pi/4
+  double tx = 0.70710678118654752;
+  double ty = 0.70710678118654752;
+  for(int n = 0; n < NITERS; n++){
+    // point on ellipse
+    const double x = a*tx;
+    const double y = b*ty;
+    // evolute
+    const double ex = +ab*tx*tx*tx/a;
+    const double ey = -ab*ty*ty*ty/b;
+    // move along the arc of the circle of curvature
+    const double rx =  x-ex;
+    const double ry =  y-ey;
+    const double qx = px-ex;
+    const double qy = py-ey;
+    const double r = sqrt(rx*rx+ry*ry);
+    const double q = sqrt(qx*qx+qy*qy)+DBL_MIN;
+    tx = clamp((qx*r/q+ex)/a);
+    ty = clamp((qy*r/q+ey)/b);
+    const double t = sqrt(tx*tx+ty*ty);
+    tx /= t;
+    ty /= t;
+  }
+  // distance to the nearest point, positive inside and negative outside
+  const double dx = a*tx-px;
+  const double dy = b*ty-py;
+  const double f0 = 1.-(px/a)*(px/a)-(py/b)*(py/b);
+  return copysign(sqrt(dx*dx+dy*dy), f0);
+}
+
+// signed distance from an ellipse whose center is at (0, 0) and major/minor axes are a and b
+//   to (x_, y_), positive inside and negative outside
+double compute_signed_dist(const double a, const double b, const double x_, const double y_){
+  return signed_dist_kernel(a, b, x_, y_);
+}
+
+// signed distances from an ellipse whose center is at (x0, y0) and rotated by angle
+//   to n points on a row (xs[0 : n-1], y),
+//   where (cosine, sine) = (cos(angle), sin(angle))
+int compute_signed_dists(const double a, const double b, const double x0, const double y0, const double cosine, const double sine, const double y, const int n, const double * restrict xs, double * restrict dists){
+  const double dy = y-y0;
+  for(int i = 0; i < n; i++){
+    // cancel rotation
+    const double dx = xs[i]-x0;
+    const double x_ = +cosine*dx+sine*dy;
+    const double y_ = -sine*dx+cosine*dy;
+    dists[i] = signed_dist_kernel(a, b, x_, y_);
+  }
+  return 0;
+}
+
+#undef NITERS
+
+#if defined(DEBUG_TEST)
+
+// accuracy and speed of compute_signed_dists compared to find_normal_t
+// mpicc -DDEBUG_TEST -O3 -std=c99 -fno-math-errno -fno-trapping-math -Iinclude src/ellipse.c -lm
+// ./a.out <a> <b> <number of points in each direction>
+
+#include <stdio.h>
+#include <time.h>
+#include <assert.h>
+
+static double reference(const double a, const double b, const double x_, const double y_){
+  const double sign = 1.-pow(x_/a, 2.)-pow(y_/b, 2.) > 0. ? +1. : -1.;
+  const double t = find_normal_t(a, b, x_, y_);
+  return sign*sqrt(pow(a*cos(t)-x_, 2.)+pow(b*sin(t)-y_, 2.));
+}
+
+int main(const int argc, const char *argv[]){
+  assert(argc == 4); // __FILE__, a, b, npoints
+  const double a = strtod(argv[1], NULL);
+  const double b = strtod(argv[2], NULL);
+  const int npoints = (int)strtol(argv[3], NULL, 10);
+  assert(0. < a);
+  assert(0. < b);
+  assert(0 < npoints);
+  // points in the bounding box, enlarged by 50 percent
+  const double l = 1.5*fmax(a, b);
+  const double h = 2.*l/npoints;
+  double *xs = calloc(npoints, sizeof(double));
+  double *dists0 = calloc(npoints*npoints, sizeof(double));
+  double *dists1 = calloc(npoints*npoints, sizeof(double));
+  for(int i = 0; i < npoints; i++){
+    xs[i] = -l+(i+0.5)*h;
+  }
+  // reference
+  clock_t tic = clock();
+  for(int j = 0; j < npoints; j++){
+    const double y = -l+(j+0.5)*h;
+    for(int i = 0; i < npoints; i++){
+      dists0[j*npoints+i] = reference(a, b, xs[i], y);
+    }
+  }
+  const double time0 = (double)(clock()-tic)/CLOCKS_PER_SEC;
+  // fixed-cost kernel
+  tic = clock();
+  for(int j = 0; j < npoints; j++){
+    const double y = -l+(j+0.5)*h;
+    compute_signed_dists(a, b, 0., 0., 1., 0., y, npoints, xs, dists1+j*npoints);
+  }
+  const double time1 = (double)(clock()-tic)/CLOCKS_PER_SEC;
+  // maximum differences normalised by the point spacing,
+  //   in the whole box and in the vicinity of the surface (3 spacings)
+  double diff_all = 0.;
+  double diff_near = 0.;
+  for(int n = 0; n < npoints*npoints; n++){
+    const double diff = fabs(dists1[n]-dists0[n])/h;
+    diff_all = fmax(diff_all, diff);
+    if(fabs(dists0[n]) < 3.*h){
+      diff_near = fmax(diff_near, diff);
+    }
+  }
+  printf("find_normal_t        : % .3e [s]\n", time0);
+  printf("compute_signed_dists : % .3e [s]\n", time1);
+  printf("max diff (all)       : % .3e\n", diff_all);
+  printf("max diff (surface)   : % .3e\n", diff_near);
+  free(xs);
+  free(dists0);
+  free(dists1);
+  return 0;
+}
+
+#endif // DEBUG_TEST
@@ -171,9 +171,10 @@ static int check_energy(const char fname[], const param_t *param, const parallel
   return 0;
 }
 
-static int check_particle(const char fname[], const param_t *param, const parallel_t *parallel, const particle_t *p){
-  const int mpirank = parallel->mpirank;
-  if(mpirank == 0){
+static int check_particle(const char fname[], const param_t *param, const parallel_t *parallel, const suspensions_t *suspensions, const int n){
+  // written by the process which is responsible for this particle
+  const particle_t *p = suspensions->particles[n];
+  if(suspensions_is_owner(parallel, suspensions, n)){
     FILE *fp = NULL;
     if(param->step == 0){
       fp = fileio_fopen(fname, "w");
@@ -201,8 +202,8 @@ int logging(param_t *param, const parallel_t *parallel, const fluid_t *fluid, co
   check_energy    (FILEIO_LOG "/energy.dat",     param, parallel, fluid);
   for(int n = 0; n < suspensions->n_particles; n++){
     char fname[128];
-    sprintf(fname, "%s/particle%010d.dat", FILEIO_LOG, n);
-    check_particle(fname, param, parallel, suspensions->particles[n]);
+    sprintf(fname, "%s/particle%010d.dat", FILEIO_LOG, suspensions->particles[n]->id);
+    check_particle(fname, param, parallel, suspensions, n);
   }
   return 0;
 }
@@ -11,6 +11,8 @@
 
 
 static int integrate(const param_t *param, const parallel_t *parallel, fluid_t *fluid, suspensions_t *suspensions){
+  // redistribute particles among processes if needed
+  suspensions_migrate_particles(param, parallel, suspensions);
   for(int rkstep = 0; rkstep < RKSTEPMAX; rkstep++){
     suspensions_reset_particle_increments(suspensions);
     /* ! update boundary and halo values ! 3 ! */
@@ -73,6 +73,8 @@ int param_decide_dt(param_t *param, const parallel_t *parallel, const fluid_t *f
       double val = fmax(pux, puy);
       dt_par = fmin(dt_par, delta/val);
     }
+    // processes may have different particles
+    MPI_Allreduce(MPI_IN_PLACE, &dt_par, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
     dt_par *= param->safefactors[2];
   }
   /* ! time step size is assigned ! 1 ! */
@@ -98,6 +98,15 @@ static int load_config(param_t *param){
   param->Fr      = load_double("Fr", DBL_MAX);
   // external force in y
   param->extfrcy = load_double("extfrcy", 2.337e-4);
+  // 1: cell list, 0: all pairs (reference)
+  param->collision_cell_list = load_int("collision_cell_list", 1) == 0 ? false : true;
+  // skin distance of the neighbour list (in grid sizes), 0 to search every time
+  param->collision_skin = load_double("collision_skin", 2.0e+0);
+  // half width of the narrow band (in grid sizes), 0 to compute weights everywhere
+  //   weights are saturated to machine precision beyond 10 grid sizes
+  param->ibm_band_width = load_double("ibm_band_width", 1.0e+1);
+  // 1: particles are distributed to the processes whose slabs contain the centers, 0: replicated
+  param->particle_ownership = load_int("particle_ownership", 0) == 0 ? false : true;
   PRINTF_MAIN("-------------------------------------\n");
   return 0;
 }
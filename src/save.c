@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <mpi.h>
 #include "common.h"
 #include "param.h"
 #include "parallel.h"
@@ -45,50 +46,54 @@ static int save_fluid(const char dirname[], const param_t *param, const parallel
   return 0;
 }
 
-static int save_particles(const char dirname[], const suspensions_t *suspensions){
-  const int n_particles = suspensions->n_particles;
-  fileio_w_0d_serial(dirname, "n_particles", NPYIO_INT, sizeof(int), &n_particles);
+static int save_particles(const char dirname[], const parallel_t *parallel, const suspensions_t *suspensions){
+  const int mpirank = parallel->mpirank;
+  const int n_particles_total = suspensions->n_particles_total;
   // save as SOA (radii, x coordinates, y coordinates etc.) instead of AOS (particle_t **particles)
   // to reduce the number of files
-  double *dens = common_calloc(n_particles, sizeof(double));
-  double *as   = common_calloc(n_particles, sizeof(double));
-  double *bs   = common_calloc(n_particles, sizeof(double));
-  double *xs   = common_calloc(n_particles, sizeof(double));
-  double *ys   = common_calloc(n_particles, sizeof(double));
-  double *azs  = common_calloc(n_particles, sizeof(double));
-  double *uxs  = common_calloc(n_particles, sizeof(double));
-  double *uys  = common_calloc(n_particles, sizeof(double));
-  double *vzs  = common_calloc(n_particles, sizeof(double));
-  for(int n = 0; n < n_particles; n++){
-    particle_t *p = suspensions->particles[n];
-    dens[n] = p->den;
-    as[n]   = p->a;
-    bs[n]   = p->b;
-    xs[n]   = p->x;
-    ys[n]   = p->y;
-    azs[n]  = p->az;
-    uxs[n]  = p->ux;
-    uys[n]  = p->uy;
-    vzs[n]  = p->vz;
+  const int nitems = 9;
+  double *buf = common_calloc(nitems*n_particles_total, sizeof(double));
+  double *dens = buf+0*n_particles_total;
+  double *as   = buf+1*n_particles_total;
+  double *bs   = buf+2*n_particles_total;
+  double *xs   = buf+3*n_particles_total;
+  double *ys   = buf+4*n_particles_total;
+  double *azs  = buf+5*n_particles_total;
+  double *uxs  = buf+6*n_particles_total;
+  double *uys  = buf+7*n_particles_total;
+  double *vzs  = buf+8*n_particles_total;
+  // each particle is given by one process and the others are zero
+  for(int n = 0; n < suspensions->n_particles; n++){
+    if(!suspensions_is_owner(parallel, suspensions, n)){
+      continue;
+    }
+    const particle_t *p = suspensions->particles[n];
+    const int m = p->id;
+    dens[m] = p->den;
+    as[m]   = p->a;
+    bs[m]   = p->b;
+    xs[m]   = p->x;
+    ys[m]   = p->y;
+    azs[m]  = p->az;
+    uxs[m]  = p->ux;
+    uys[m]  = p->uy;
+    vzs[m]  = p->vz;
+  }
+  // collected by the main process
+  MPI_Reduce(mpirank == 0 ? MPI_IN_PLACE : buf, buf, nitems*n_particles_total, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  if(mpirank == 0){
+    fileio_w_0d_serial(dirname, "n_particles", NPYIO_INT, sizeof(int), &n_particles_total);
+    fileio_w_1d_serial(dirname, "particle_dens", NPYIO_DOUBLE, sizeof(double), n_particles_total, dens);
+    fileio_w_1d_serial(dirname, "particle_as",   NPYIO_DOUBLE, sizeof(double), n_particles_total,   as);
+    fileio_w_1d_serial(dirname, "particle_bs",   NPYIO_DOUBLE, sizeof(double), n_particles_total,   bs);
+    fileio_w_1d_serial(dirname, "particle_xs",   NPYIO_DOUBLE, sizeof(double), n_particles_total,   xs);
+    fileio_w_1d_serial(dirname, "particle_ys",   NPYIO_DOUBLE, sizeof(double), n_particles_total,   ys);
+    fileio_w_1d_serial(dirname, "particle_azs",  NPYIO_DOUBLE, sizeof(double), n_particles_total,  azs);
+    fileio_w_1d_serial(dirname, "particle_uxs",  NPYIO_DOUBLE, sizeof(double), n_particles_total,  uxs);
+    fileio_w_1d_serial(dirname, "particle_uys",  NPYIO_DOUBLE, sizeof(double), n_particles_total,  uys);
+    fileio_w_1d_serial(dirname, "particle_vzs",  NPYIO_DOUBLE, sizeof(double), n_particles_total,  vzs);
   }
-  fileio_w_1d_serial(dirname, "particle_dens", NPYIO_DOUBLE, sizeof(double), n_particles, dens);
-  fileio_w_1d_serial(dirname, "particle_as",   NPYIO_DOUBLE, sizeof(double), n_particles,   as);
-  fileio_w_1d_serial(dirname, "particle_bs",   NPYIO_DOUBLE, sizeof(double), n_particles,   bs);
-  fileio_w_1d_serial(dirname, "particle_xs",   NPYIO_DOUBLE, sizeof(double), n_particles,   xs);
-  fileio_w_1d_serial(dirname, "particle_ys",   NPYIO_DOUBLE, sizeof(double), n_particles,   ys);
-  fileio_w_1d_serial(dirname, "particle_azs",  NPYIO_DOUBLE, sizeof(double), n_particles,  azs);
-  fileio_w_1d_serial(dirname, "particle_uxs",  NPYIO_DOUBLE, sizeof(double), n_particles,  uxs);
-  fileio_w_1d_serial(dirname, "particle_uys",  NPYIO_DOUBLE, sizeof(double), n_particles,  uys);
-  fileio_w_1d_serial(dirname, "particle_vzs",  NPYIO_DOUBLE, sizeof(double), n_particles,  vzs);
-  common_free(dens);
-  common_free(as);
-  common_free(bs);
-  common_free(xs);
-  common_free(ys);
-  common_free(azs);
-  common_free(uxs);
-  common_free(uys);
-  common_free(vzs);
+  common_free(buf);
   return 0;
 }
 
@@ -114,9 +119,7 @@ int save(param_t *param, const parallel_t *parallel, const fluid_t *fluid, const
   }
   /* ! save flow fields ! 1 ! */
   save_fluid(dirname, param, parallel, fluid);
-  if(mpirank == 0){
-    save_particles(dirname, suspensions);
-  }
+  save_particles(dirname, parallel, suspensions);
   common_free(dirname);
   return 0;
 }
@@ -46,37 +46,30 @@ static int collect_mean_uy(const param_t *param, const parallel_t *parallel, con
 }
 
 static int collect_mean_phi(const param_t *param, const parallel_t *parallel, const suspensions_t *suspensions, statistics_t *statistics){
-  const int mpisize = parallel->mpisize;
-  const int mpirank = parallel->mpirank;
   const int itot = param->itot;
-  const int jtot = param->jtot;
-  const int jsize = parallel_get_size(jtot, mpisize, mpirank);
-  const double ly = param->ly;
-  const double *xc = param->xc;
-  const double *yc = param->yc;
   double *phi = statistics->phi;
-  const int n_particles = suspensions->n_particles;
-  for(int n = 0; n < n_particles; n++){
+  // images intersecting this process
+  const image_list_t *list = suspensions->image_list;
+  suspensions_update_image_list(param, parallel, false, suspensions);
+  for(int e = 0; e < list->n_entries; ){
+    const int n = list->indices[e];
     const particle_t *p = suspensions->particles[n];
-    const double pa = p->a;
-    const double pb = p->b;
-    const double px = p->x;
-    const double py = p->y;
-    const double paz = p->az;
-    for(int periodic = -1; periodic <= 1; periodic++){
-      double py_ = py+ly*periodic;
-      for(int j = 1; j <= jsize; j++){
-        const double y = YC(j);
-        for(int i = 1; i <= itot; i++){
-          const double x = XC(i);
-          double dx = x-px;
-          double dy = y-py_;
-          double c = cos(-paz);
-          double s = sin(-paz);
-          double x_ = c*dx-s*dy;
-          double y_ = s*dx+c*dy;
+    // IBM weights are reused if they are up-to-date
+    geometry_t geometry;
+    suspensions_compute_geometry(p, p->x, p->y, p->az, &geometry);
+    stencil_t *stencil = suspensions->stencils+n;
+    suspensions_update_stencil(param, parallel, &geometry, stencil);
+    for(; e < list->n_entries && list->indices[e] == n; e++){
+      const stencil_image_t *image = stencil->images+list->periodics[e]+1;
+      const int jmin = image->jmin;
+      const int jmax = image->jmax;
+      for(int j = jmin; j <= jmax; j++){
+        const int imin = image->imins[j-jmin];
+        const int imax = image->imaxs[j-jmin];
+        const double *v_weights = image->v_weights+image->offsets[j-jmin];
+        for(int i = imin; i <= imax; i++){
           // add 1 if this point is inside the ellipse, otherwise do nothing
-          PHI(i, j) += 1.-pow(x_/pa, 2.)-pow(y_/pb, 2.) > 0. ? 1. : 0.;
+          PHI(i, j) += v_weights[i-imin] > 0.5 ? 1. : 0.;
         }
       }
     }
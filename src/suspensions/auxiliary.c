@@ -16,48 +16,148 @@ int suspensions_decide_loop_size(const int lbound, const int ubound, const doubl
   return 0;
 }
 
-static double compute_signed_dist(const double grid_size, const double pa, const double pb, const double px, const double py, const double paz, const double x, const double y){
+int suspensions_compute_geometry(const particle_t *p, const double px, const double py, const double paz, geometry_t *geometry){
+  geometry->a = p->a;
+  geometry->b = p->b;
+  geometry->inv_a2 = 1./POW2(p->a);
+  geometry->inv_b2 = 1./POW2(p->b);
+  geometry->x = px;
+  geometry->y = py;
+  geometry->az = paz;
+  geometry->cosaz = cos(paz);
+  geometry->sinaz = sin(paz);
+  geometry->radius = fmax(p->a, p->b);
+  geometry->mass = suspensions_compute_mass(p->den, p->a, p->b);
+  geometry->moment_of_inertia = suspensions_compute_moment_of_inertia(p->den, p->a, p->b);
+  return 0;
+}
+
+int suspensions_decide_row_size(const int lbound, const int ubound, const double grid_size, const double band, const geometry_t *geometry, const double y, int *min, int *max){
+  // narrow [lbound : ubound] to the cell centers on the row y
+  //   where the level q = sqrt( (x/a)^2 + (y/b)^2 ) is no larger than 1 + band / min(a, b),
+  //   which contains all points closer to the surface than band
+  // max < min when the row does not intersect
+  *min = lbound;
+  *max = ubound;
+  if(band <= 0.){
+    return 0;
+  }
+  const double cosaz = geometry->cosaz;
+  const double sinaz = geometry->sinaz;
+  const double inv_a2 = geometry->inv_a2;
+  const double inv_b2 = geometry->inv_b2;
+  const double q2max = POW2(1.+band/fmin(geometry->a, geometry->b));
+  const double dy = y-geometry->y;
+  // q^2 = A dx^2 + B dx + C + q2max, where dx is the distance in x from the gravity center
+  const double A = POW2(cosaz)*inv_a2+POW2(sinaz)*inv_b2;
+  const double B = 2.*dy*cosaz*sinaz*(inv_a2-inv_b2);
+  const double C = POW2(dy)*(POW2(sinaz)*inv_a2+POW2(cosaz)*inv_b2)-q2max;
+  const double disc = POW2(B)-4.*A*C;
+  if(disc < 0.){
+    *max = *min-1;
+    return 0;
+  }
+  const double dxmin = (-B-sqrt(disc))/(2.*A);
+  const double dxmax = (-B+sqrt(disc))/(2.*A);
+  // cell centers are at (i-1/2) grid_size, rounded outwards
+  const int imin = (int)floor((geometry->x+dxmin)/grid_size+0.5);
+  const int imax = (int)ceil ((geometry->x+dxmax)/grid_size+0.5);
+  *min = imin > lbound ? imin : lbound;
+  *max = imax < ubound ? imax : ubound;
+  return 0;
+}
+
+static double compute_normalised_signed_dist(const double grid_size, const geometry_t *geometry, const double x, const double y){
   // transform to the origin and cancel rotation
   // an ellise goes to (0, 0) and the rotation leads 0
   // the target point (x, y) moves to (x_, y_)
-  double x_, y_, sign;
+  double x_, y_;
   {
-    double dx = x-px;
-    double dy = y-py;
-    double c = cos(-paz);
-    double s = sin(-paz);
-    x_ = c*dx-s*dy;
-    y_ = s*dx+c*dy;
+    double dx = x-geometry->x;
+    double dy = y-geometry->y;
+    x_ = +geometry->cosaz*dx+geometry->sinaz*dy;
+    y_ = -geometry->sinaz*dx+geometry->cosaz*dy;
   }
-  // check whether (x_, y_) is inside an ellipse whose center is at (0, 0) and major/minor axes are pa and pb.
-  // inside: sign=+1, outside: sign=-1
-  {
-    // NOTE: f0 > 0 : inside, f0 < 0 : outside
-    double f0 = 1.-POW2(x_/pa)-POW2(y_/pb);
-    sign = f0 > 0. ? +1. : -1.;
-  }
-  double t = find_normal_t(pa, pb, x_, y_);
-  // the nearest point on the ellipse: (a cos(t), b sin(t))
-  // compute signed distance
-  double dist = sign*sqrt(
-      +POW2(pa*cos(t)-x_)
-      +POW2(pb*sin(t)-y_)
-  );
+  // inside: positive, outside: negative
+  double dist = compute_signed_dist(geometry->a, geometry->b, x_, y_);
   return dist/grid_size;
 }
 
 #define BETA 2.
 
-double suspensions_s_weight(const double grid_size, const double pa, const double pb, const double px, const double py, const double paz, const double x, const double y){
-  double dist = compute_signed_dist(grid_size, pa, pb, px, py, paz, x, y);
+double suspensions_s_weight(const double grid_size, const geometry_t *geometry, const double x, const double y){
+  double dist = compute_normalised_signed_dist(grid_size, geometry, x, y);
   return 0.5*BETA*(1.-POW2(tanh(BETA*dist)));
 }
 
-double suspensions_v_weight(const double grid_size, const double pa, const double pb, const double px, const double py, const double paz, const double x, const double y){
-  double dist = compute_signed_dist(grid_size, pa, pb, px, py, paz, x, y);
+double suspensions_v_weight(const double grid_size, const geometry_t *geometry, const double x, const double y){
+  double dist = compute_normalised_signed_dist(grid_size, geometry, x, y);
   return 0.5*(1.+tanh(BETA*dist));
 }
 
+static int compute_weights_exactly(const double grid_size, const geometry_t *geometry, const double y, const int n, const double *xs, double *s_ws, double *v_ws){
+  compute_signed_dists(geometry->a, geometry->b, geometry->x, geometry->y, geometry->cosaz, geometry->sinaz, y, n, xs, v_ws);
+  for(int i = 0; i < n; i++){
+    double dist = v_ws[i]/grid_size;
+    double t = tanh(BETA*dist);
+    s_ws[i] = 0.5*BETA*(1.-POW2(t));
+    v_ws[i] = 0.5*(1.+t);
+  }
+  return 0;
+}
+
+// surface and volume weights of n points on a row (xs[0 : n-1], y) at once,
+//   distances are computed by the vectorised kernel first
+// when band_width (in grid sizes) is positive, distances are computed only in the narrow band
+//   around the surface, and the weights are saturated outside the band
+int suspensions_compute_weights(const double grid_size, const double band_width, const geometry_t *geometry, const double y, const int n, const double *xs, double *s_ws, double *v_ws){
+  if(band_width <= 0.){
+    compute_weights_exactly(grid_size, geometry, y, n, xs, s_ws, v_ws);
+    return 0;
+  }
+  // a point on the level q = sqrt( (x/a)^2 + (y/b)^2 ) is
+  //   at least (q-1) min(a, b) away from the surface when q > 1 (outside)
+  //   at least (1-q) min(a, b) away from the surface when q < 1 (inside)
+  //   since the ellipse contains a circle of radius min(a, b)
+  const double delta = band_width*grid_size/fmin(geometry->a, geometry->b);
+  const double q2max = POW2(1.+delta);
+  const double q2min = delta < 1. ? POW2(1.-delta) : -1.;
+  // squared levels, stored in s_ws temporarily
+  {
+    const double dy = y-geometry->y;
+    for(int i = 0; i < n; i++){
+      const double dx = xs[i]-geometry->x;
+      const double x_ = +geometry->cosaz*dx+geometry->sinaz*dy;
+      const double y_ = -geometry->sinaz*dx+geometry->cosaz*dy;
+      s_ws[i] = POW2(x_)*geometry->inv_a2+POW2(y_)*geometry->inv_b2;
+    }
+  }
+  for(int i = 0; i < n; ){
+    if(s_ws[i] >= q2max){
+      // far outside
+      s_ws[i] = 0.;
+      v_ws[i] = 0.;
+      i += 1;
+      continue;
+    }
+    if(s_ws[i] <= q2min){
+      // deep inside
+      s_ws[i] = 0.;
+      v_ws[i] = 1.;
+      i += 1;
+      continue;
+    }
+    // consecutive points in the band are computed at once
+    int i1 = i+1;
+    while(i1 < n && q2min < s_ws[i1] && s_ws[i1] < q2max){
+      i1 += 1;
+    }
+    compute_weights_exactly(grid_size, geometry, y, i1-i, xs+i, s_ws+i, v_ws+i);
+    i = i1;
+  }
+  return 0;
+}
+
 #undef BETA
 
 double suspensions_compute_volume(const double a, const double b){
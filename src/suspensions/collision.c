@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 #include <float.h>
 #include "common.h"
@@ -13,8 +14,8 @@ typedef struct ellipse_t_ {
   double a, b;
   // gravity center
   double x, y;
-  // rotation angle (from major axis)
-  double angle;
+  // rotation matrix, cos and sin of the rotation angle (from major axis)
+  double cosa, sina;
 } ellipse_t;
 
 typedef struct circle_t_ {
@@ -67,14 +68,28 @@ static int get_my_range(const parallel_t *parallel, const int n_total, int *n_mi
   return 0;
 }
 
+static int get_my_particles(const parallel_t *parallel, const suspensions_t *suspensions, int *n_min, int *n_max){
+  // particles whose collisions are handled by this process
+  //   distributed: owned particles, which are the first n_owned particles
+  //   replicated : divided evenly
+  if(suspensions->ownership != NULL){
+    *n_min = 0;
+    *n_max = suspensions->ownership->n_owned;
+  }else{
+    get_my_range(parallel, suspensions->n_particles, n_min, n_max);
+  }
+  return 0;
+}
+
 static double harmonic_average(const double v0, const double v1){
   double retval = 0.5*(1./v0+1./v1);
   return 1./retval;
 }
 
-static int compute_evolute(const ellipse_t *e, const double x, const double y, double *ex, double *ey, double *ix, double *iy, double *r){
+static int compute_evolute(const ellipse_t *e, const double x, const double y, double *t, double *ex, double *ey, double *ix, double *iy, double *r){
   // e: ellipse
   // (x, y): target point
+  // t: parameter of the ellipse, initial guess as input and answer as output
   // (ex, ey): center of evolute
   // (ix, iy): intersection of fitted circle and ellipse
   // forward transformation
@@ -82,43 +97,52 @@ static int compute_evolute(const ellipse_t *e, const double x, const double y, d
   {
     double x__ = x - e->x;
     double y__ = y - e->y;
-    x_ = cos(-e->angle) * x__ - sin(-e->angle) * y__;
-    y_ = sin(-e->angle) * x__ + cos(-e->angle) * y__;
+    x_ = + e->cosa * x__ + e->sina * y__;
+    y_ = - e->sina * x__ + e->cosa * y__;
   }
-  double t = find_normal_t(e->a, e->b, x_, y_);
-  *r = 1./fmax(compute_curvature(e->a, e->b, t), DBL_EPSILON);
+  *t = find_normal_t_from(e->a, e->b, x_, y_, *t);
+  *r = 1./fmax(compute_curvature(e->a, e->b, *t), DBL_EPSILON);
   // find corresponding evolute
-  x_ = compute_ex(e->a, e->b, t);
-  y_ = compute_ey(e->a, e->b, t);
+  x_ = compute_ex(e->a, e->b, *t);
+  y_ = compute_ey(e->a, e->b, *t);
   // inverse transformation
   {
-    *ex = cos(+e->angle) * x_ - sin(+e->angle) * y_;
-    *ey = sin(+e->angle) * x_ + cos(+e->angle) * y_;
+    *ex = e->cosa * x_ - e->sina * y_;
+    *ey = e->sina * x_ + e->cosa * y_;
     *ex = *ex + e->x;
     *ey = *ey + e->y;
   }
   // find intersection
-  x_ = e->a*cos(t);
-  y_ = e->b*sin(t);
+  x_ = e->a*cos(*t);
+  y_ = e->b*sin(*t);
   // inverse transformation
   {
-    *ix = cos(+e->angle) * x_ - sin(+e->angle) * y_;
-    *iy = sin(+e->angle) * x_ + cos(+e->angle) * y_;
+    *ix = e->cosa * x_ - e->sina * y_;
+    *iy = e->sina * x_ + e->cosa * y_;
   }
   return 0;
 }
 
-static int find_equivalent_circles(const ellipse_t *e0, const ellipse_t *e1, circle_t *c0, circle_t *c1, double *ix0, double *iy0, double *ix1, double *iy1){
+static int compute_centre_of_curvature(const ellipse_t *e, const double t, double *ex, double *ey){
+  // centre of curvature of the ellipse at t, in the global coordinate
+  const double x_ = compute_ex(e->a, e->b, t);
+  const double y_ = compute_ey(e->a, e->b, t);
+  *ex = e->cosa * x_ - e->sina * y_ + e->x;
+  *ey = e->sina * x_ + e->cosa * y_ + e->y;
+  return 0;
+}
+
+// upper limit of the fixed-point iterations to find equivalent circles
+static const int n_iters_max = 100;
+
+static bool iterate_equivalent_circles(const ellipse_t *e0, const ellipse_t *e1, double *t0, double *t1, circle_t *c0, circle_t *c1, double *ix0, double *iy0, double *ix1, double *iy1){
+  // returns false when the iteration does not converge within the limit
   const double small = 1.e-8;
-  c0->x = e0->x;
-  c0->y = e0->y;
-  c1->x = e1->x;
-  c1->y = e1->y;
-  for(int n = 0; ; n++){
+  for(int n = 0; n < n_iters_max; n++){
     double c0_x, c0_y;
     double c1_x, c1_y;
-    compute_evolute(e0, c1->x, c1->y, &c0_x, &c0_y, ix0, iy0, &c0->r);
-    compute_evolute(e1, c0->x, c0->y, &c1_x, &c1_y, ix1, iy1, &c1->r);
+    compute_evolute(e0, c1->x, c1->y, t0, &c0_x, &c0_y, ix0, iy0, &c0->r);
+    compute_evolute(e1, c0->x, c0->y, t1, &c1_x, &c1_y, ix1, iy1, &c1->r);
     double dc0_x = c0_x-c0->x;
     double dc0_y = c0_y-c0->y;
     double dc1_x = c1_x-c1->x;
@@ -128,38 +152,120 @@ static int find_equivalent_circles(const ellipse_t *e0, const ellipse_t *e1, cir
     c1->x += dc1_x;
     c1->y += dc1_y;
     if(fmax(fmax(fabs(dc0_x), fabs(dc0_y)), fmax(fabs(dc1_x), fabs(dc1_y))) < small){
-      break;
+      return true;
     }
   }
+  return false;
+}
+
+static int find_equivalent_circles(const ellipse_t *e0, const ellipse_t *e1, collision_contact_t *contact, circle_t *c0, circle_t *c1, double *ix0, double *iy0, double *ix1, double *iy1){
+  // contact: cache of the previous answer, NULL to always start from the gravity centres
+  double t0 = 0.25*M_PI;
+  double t1 = 0.25*M_PI;
+  bool is_converged = false;
+  // warm start from the previous answer
+  if(contact != NULL && contact->is_valid){
+    t0 = contact->t0;
+    t1 = contact->t1;
+    compute_centre_of_curvature(e0, t0, &c0->x, &c0->y);
+    compute_centre_of_curvature(e1, t1, &c1->x, &c1->y);
+    is_converged = iterate_equivalent_circles(e0, e1, &t0, &t1, c0, c1, ix0, iy0, ix1, iy1);
+  }
+  // cold start from the gravity centres,
+  //   also as a fallback when the warm start fails
+  if(!is_converged){
+    t0 = 0.25*M_PI;
+    t1 = 0.25*M_PI;
+    c0->x = e0->x;
+    c0->y = e0->y;
+    c1->x = e1->x;
+    c1->y = e1->y;
+    is_converged = iterate_equivalent_circles(e0, e1, &t0, &t1, c0, c1, ix0, iy0, ix1, iy1);
+  }
+  // the last iterate is used anyway, but is not cached when not converged
+  if(contact != NULL){
+    contact->is_valid = is_converged;
+    contact->t0 = t0;
+    contact->t1 = t1;
+  }
   return 0;
 }
 
-static int find_equivalent_circle(const ellipse_t *e, const double wallx, circle_t *c, double *ix, double *iy){
+static bool iterate_equivalent_circle(const ellipse_t *e, const double wallx, double *t, circle_t *c, double *ix, double *iy){
+  // returns false when the iteration does not converge within the limit
   const double small = 1.e-8;
-  c->x = e->x;
-  c->y = e->y;
-  for(int n = 0; ; n++){
+  for(int n = 0; n < n_iters_max; n++){
     double c_x, c_y;
     double mirrorx = 2.*wallx-c->x;
-    compute_evolute(e, mirrorx, c->y, &c_x, &c_y, ix, iy, &c->r);
+    compute_evolute(e, mirrorx, c->y, t, &c_x, &c_y, ix, iy, &c->r);
     double dc_x = c_x-c->x;
     double dc_y = c_y-c->y;
     c->x += dc_x;
     c->y += dc_y;
     if(fmax(fabs(dc_x), fabs(dc_y)) < small){
-      break;
+      return true;
     }
   }
+  return false;
+}
+
+static int find_equivalent_circle(const ellipse_t *e, const double wallx, collision_contact_t *contact, circle_t *c, double *ix, double *iy){
+  // same as find_equivalent_circles, the mirrored circle is the partner
+  double t = 0.25*M_PI;
+  bool is_converged = false;
+  if(contact != NULL && contact->is_valid){
+    t = contact->t0;
+    compute_centre_of_curvature(e, t, &c->x, &c->y);
+    is_converged = iterate_equivalent_circle(e, wallx, &t, c, ix, iy);
+  }
+  if(!is_converged){
+    t = 0.25*M_PI;
+    c->x = e->x;
+    c->y = e->y;
+    is_converged = iterate_equivalent_circle(e, wallx, &t, c, ix, iy);
+  }
+  if(contact != NULL){
+    contact->is_valid = is_converged;
+    contact->t0 = t;
+  }
   return 0;
 }
 
-static int compute_collision_force_p_p(const param_t *param, const int cnstep, particle_t *p0, particle_t *p1){
+static bool bounding_boxes_are_separated(const ellipse_t *e0, const ellipse_t *e1){
+  // separating-axis test of the oriented bounding boxes of two ellipses,
+  //   candidate axes are the major and minor axes of the two ellipses
+  const double dx = e1->x-e0->x;
+  const double dy = e1->y-e0->y;
+  const double cos0 = e0->cosa;
+  const double sin0 = e0->sina;
+  const double cos1 = e1->cosa;
+  const double sin1 = e1->sina;
+  const double axes[4][2] = {
+    {+cos0, +sin0},
+    {-sin0, +cos0},
+    {+cos1, +sin1},
+    {-sin1, +cos1},
+  };
+  for(int n = 0; n < 4; n++){
+    const double lx = axes[n][0];
+    const double ly = axes[n][1];
+    // projected half widths of the boxes and distance between the centres
+    const double r0 = e0->a*fabs(cos0*lx+sin0*ly)+e0->b*fabs(-sin0*lx+cos0*ly);
+    const double r1 = e1->a*fabs(cos1*lx+sin1*ly)+e1->b*fabs(-sin1*lx+cos1*ly);
+    if(fabs(dx*lx+dy*ly) > r0+r1){
+      return true;
+    }
+  }
+  return false;
+}
+
+static int compute_collision_force_p_p(const param_t *param, const int cnstep, particle_t *p0, particle_t *p1, const geometry_t *g0, const geometry_t *g1, collision_contact_t *contact){
   // correct periodicity
   double yoffset = 0.;
   {
     const double ly = param->ly;
-    const double p0y = p0->y+p0->dy;
-    const double p1y = p1->y+p1->dy;
+    const double p0y = g0->y;
+    const double p1y = g1->y;
     double minval = DBL_MAX;
     for(int periodic = -1; periodic <= 1; periodic++){
       double val = fabs((p1y+ly*periodic) - p0y);
@@ -171,12 +277,12 @@ static int compute_collision_force_p_p(const param_t *param, const int cnstep, p
   }
   // check collision of larger circles for early return
   {
-    double x0 = p0->x+p0->dx;
-    double y0 = p0->y+p0->dy;
-    double r0 = fmax(p0->a, p0->b);
-    double x1 = p1->x+p1->dx;
-    double y1 = p1->y+p1->dy+yoffset;
-    double r1 = fmax(p1->a, p1->b);
+    double x0 = g0->x;
+    double y0 = g0->y;
+    double r0 = g0->radius;
+    double x1 = g1->x;
+    double y1 = g1->y+yoffset;
+    double r1 = g1->radius;
     double nx = x1-x0;
     double ny = y1-y0;
     double norm = fmax(hypot(nx, ny), DBL_EPSILON);
@@ -184,39 +290,50 @@ static int compute_collision_force_p_p(const param_t *param, const int cnstep, p
     ny /= norm;
     double overlap_dist = r0+r1-norm;
     if(overlap_dist < 0.){
+      // previous contact is too old to be used as a guess
+      if(contact != NULL){
+        contact->is_valid = false;
+      }
       return 0;
     }
   }
   // convert ellipse to circles
   ellipse_t e0 = {
-    .a = p0->a,
-    .b = p0->b,
-    .x = p0->x+p0->dx,
-    .y = p0->y+p0->dy,
-    .angle = p0->az
+    .a = g0->a,
+    .b = g0->b,
+    .x = g0->x,
+    .y = g0->y,
+    .cosa = g0->cosaz,
+    .sina = g0->sinaz
   };
   ellipse_t e1 = {
-    .a = p1->a,
-    .b = p1->b,
-    .x = p1->x+p1->dx,
-    .y = p1->y+p1->dy+yoffset,
-    .angle = p1->az
+    .a = g1->a,
+    .b = g1->b,
+    .x = g1->x,
+    .y = g1->y+yoffset,
+    .cosa = g1->cosaz,
+    .sina = g1->sinaz
   };
+  // check collision of bounding boxes for early return,
+  //   the contact cache is kept since the pair is still close
+  if(bounding_boxes_are_separated(&e0, &e1)){
+    return 0;
+  }
   circle_t c0, c1;
   double ix0, iy0, ix1, iy1;
-  find_equivalent_circles(&e0, &e1, &c0, &c1, &ix0, &iy0, &ix1, &iy1);
+  find_equivalent_circles(&e0, &e1, contact, &c0, &c1, &ix0, &iy0, &ix1, &iy1);
   // compute force and torque
-  const double p0mass = suspensions_compute_mass(p0->den, p0->a, p0->b);
-  const double p1mass = suspensions_compute_mass(p1->den, p1->a, p1->b);
-  const double p0im   = suspensions_compute_moment_of_inertia(p0->den, p0->a, p0->b);
-  const double p1im   = suspensions_compute_moment_of_inertia(p1->den, p1->a, p1->b);
+  const double p0mass = g0->mass;
+  const double p1mass = g1->mass;
+  const double p0im   = g0->moment_of_inertia;
+  const double p1im   = g1->moment_of_inertia;
   // k: pre-factor (spring stiffness)
   double k;
   {
     const double mass = harmonic_average(p0mass, p1mass);
     // equivalent radius based on the area
-    const double r0 = sqrt(p0->a*p0->b);
-    const double r1 = sqrt(p1->a*p1->b);
+    const double r0 = sqrt(g0->a*g0->b);
+    const double r1 = sqrt(g1->a*g1->b);
     const double reft = pow(harmonic_average(r0, r1), 1.5);
     k = mass*pow(M_PI, 2.)/pow(reft, 2.);
   }
@@ -246,39 +363,43 @@ static int compute_collision_force_p_p(const param_t *param, const int cnstep, p
   return 0;
 }
 
-static int compute_collision_force_p_w(const double wallx, const int cnstep, particle_t *p){
-  // check collision of larger circles for early return
+static int compute_collision_force_p_w(const double wallx, const int cnstep, particle_t *p, const geometry_t *g, collision_contact_t *contact){
+  // check collision of the bounding box (exact extent in x) for early return
   {
-    double x = p->x+p->dx;
-    double r = fmax(p->a, p->b);
+    double x = g->x;
+    double r = hypot(g->a*g->cosaz, g->b*g->sinaz);
     double nx = wallx-x;
     double norm = fabs(nx);
     nx /= norm;
     double overlap_dist = r-norm;
     if(overlap_dist < 0.){
+      if(contact != NULL){
+        contact->is_valid = false;
+      }
       return 0;
     }
   }
   // convert ellipse to circles
   ellipse_t e = {
-    .a = p->a,
-    .b = p->b,
-    .x = p->x+p->dx,
-    .y = p->y+p->dy,
-    .angle = p->az
+    .a = g->a,
+    .b = g->b,
+    .x = g->x,
+    .y = g->y,
+    .cosa = g->cosaz,
+    .sina = g->sinaz
   };
   circle_t c;
   double ix, iy;
-  find_equivalent_circle(&e, wallx, &c, &ix, &iy);
+  find_equivalent_circle(&e, wallx, contact, &c, &ix, &iy);
   // compute force and torque
-  const double pmass = suspensions_compute_mass(p->den, p->a, p->b);
-  const double pim   = suspensions_compute_moment_of_inertia(p->den, p->a, p->b);
+  const double pmass = g->mass;
+  const double pim   = g->moment_of_inertia;
   // k: pre-factor (spring stiffness)
   double k;
   {
     const double mass = pmass;
     // equivalent radius based on the area
-    const double r = sqrt(p->a*p->b);
+    const double r = sqrt(g->a*g->b);
     const double reft = pow(r, 1.5);
     k = mass*pow(M_PI, 2.)/pow(reft, 2.);
   }
@@ -303,6 +424,211 @@ static int compute_collision_force_p_w(const double wallx, const int cnstep, par
   return 0;
 }
 
+static int collide_all_pairs(const param_t *param, const parallel_t *parallel, const int cnstep, suspensions_t *suspensions){
+  // check all N(N-1)/2 pairs, used as a reference
+  const int n_particles = suspensions->n_particles;
+  particle_t **particles = suspensions->particles;
+  const geometry_t *geometries = suspensions->geometries;
+  const int n_total = n_particles*(n_particles-1)/2;
+  int n_min, n_max;
+  if(suspensions->ownership != NULL){
+    // pairs including at least one owned particle, i.e., n0 < n_owned
+    n_min = 0;
+    n_max = get_l(n_particles, suspensions->ownership->n_owned);
+  }else{
+    get_my_range(parallel, n_total, &n_min, &n_max);
+  }
+  for(int n = n_min; n < n_max; n++){
+    int n0, n1;
+    get_particle_indices(n_particles, n, &n0, &n1);
+    compute_collision_force_p_p(param, cnstep, particles[n0], particles[n1], geometries+n0, geometries+n1, NULL);
+  }
+  return 0;
+}
+
+static int find_cell(const collision_cells_t *cells, const double ly, const double x, const double y, int *ix, int *iy){
+  const int ncellx = cells->ncellx;
+  const int ncelly = cells->ncelly;
+  // x: wall-bounded, particles slightly penetrating walls are clamped
+  *ix = (int)floor(x/cells->cellsizex);
+  *ix = *ix <        0 ?        0 : *ix;
+  *ix = *ix > ncellx-1 ? ncellx-1 : *ix;
+  // y: periodic, positions are wrapped to [0 : ly)
+  double y_ = fmod(y, ly);
+  y_ = y_ < 0. ? y_+ly : y_;
+  *iy = (int)floor(y_/cells->cellsizey);
+  *iy = *iy <        0 ?        0 : *iy;
+  *iy = *iy > ncelly-1 ? ncelly-1 : *iy;
+  return 0;
+}
+
+static int assign_cells(const param_t *param, suspensions_t *suspensions){
+  const double ly = param->ly;
+  const int n_particles = suspensions->n_particles;
+  particle_t **particles = suspensions->particles;
+  collision_cells_t *cells = suspensions->collision_cells;
+  const int ncellx = cells->ncellx;
+  const int ncelly = cells->ncelly;
+  int *heads = cells->heads;
+  int *nexts = cells->nexts;
+  for(int n = 0; n < ncellx*ncelly; n++){
+    heads[n] = -1;
+  }
+  // pushed in reverse order so that each cell lists particles in ascending order
+  for(int n = n_particles-1; n >= 0; n--){
+    const particle_t *p = particles[n];
+    int ix, iy;
+    find_cell(cells, ly, p->x+p->dx, p->y+p->dy, &ix, &iy);
+    nexts[n] = heads[iy*ncellx+ix];
+    heads[iy*ncellx+ix] = n;
+  }
+  return 0;
+}
+
+static bool are_close(const double ly, const double skin, const particle_t *p0, const particle_t *p1){
+  // distance between circumscribed circles is smaller than the skin or not (N.B. periodicity in y)
+  double dx = (p1->x+p1->dx)-(p0->x+p0->dx);
+  double dy = (p1->y+p1->dy)-(p0->y+p0->dy);
+  dy -= ly*round(dy/ly);
+  return hypot(dx, dy) <= fmax(p0->a, p0->b)+fmax(p1->a, p1->b)+skin;
+}
+
+static bool neighbours_are_outdated(const param_t *param, const suspensions_t *suspensions){
+  // the list is valid as long as all particles stay within half of the skin
+  const double ly = param->ly;
+  const int n_particles = suspensions->n_particles;
+  particle_t **particles = suspensions->particles;
+  const collision_neighbours_t *neighbours = suspensions->collision_neighbours;
+  if(!neighbours->is_built){
+    return true;
+  }
+  const double limit = 0.5*neighbours->skin;
+  for(int n = 0; n < n_particles; n++){
+    const particle_t *p = particles[n];
+    double dx = p->x+p->dx-neighbours->xs[n];
+    double dy = p->y+p->dy-neighbours->ys[n];
+    dy -= ly*round(dy/ly);
+    if(hypot(dx, dy) >= limit){
+      return true;
+    }
+  }
+  return false;
+}
+
+static int append_partner(collision_neighbours_t *neighbours, const int n1, const collision_contact_t *contact){
+  if(neighbours->n_partners == neighbours->n_partners_max){
+    // extend buffers
+    const int n_partners_max = 2*neighbours->n_partners_max;
+    int *partners = common_calloc(n_partners_max, sizeof(int));
+    collision_contact_t *contacts = common_calloc(n_partners_max, sizeof(collision_contact_t));
+    memcpy(partners, neighbours->partners, sizeof(int)*neighbours->n_partners);
+    memcpy(contacts, neighbours->contacts, sizeof(collision_contact_t)*neighbours->n_partners);
+    common_free(neighbours->partners);
+    common_free(neighbours->contacts);
+    neighbours->partners = partners;
+    neighbours->contacts = contacts;
+    neighbours->n_partners_max = n_partners_max;
+  }
+  neighbours->partners[neighbours->n_partners] = n1;
+  neighbours->contacts[neighbours->n_partners] = *contact;
+  neighbours->n_partners += 1;
+  return 0;
+}
+
+static int build_neighbours(const param_t *param, const parallel_t *parallel, suspensions_t *suspensions){
+  // collect pairs in the same or adjacent cells which are closer than the skin
+  const double ly = param->ly;
+  const int n_particles = suspensions->n_particles;
+  particle_t **particles = suspensions->particles;
+  const collision_cells_t *cells = suspensions->collision_cells;
+  const int ncellx = cells->ncellx;
+  const int ncelly = cells->ncelly;
+  const int *heads = cells->heads;
+  const int *nexts = cells->nexts;
+  collision_neighbours_t *neighbours = suspensions->collision_neighbours;
+  const double skin = neighbours->skin;
+  assign_cells(param, suspensions);
+  // each process takes care of pairs whose smaller index is in its range
+  int n_min, n_max;
+  get_my_particles(parallel, suspensions, &n_min, &n_max);
+  // keep the previous list to inherit contact caches of the surviving pairs
+  const int n_partners_prev = neighbours->is_built ? neighbours->n_partners : 0;
+  int *offsets_prev = common_calloc(n_particles+1, sizeof(int));
+  int *partners_prev = common_calloc(neighbours->n_partners_max, sizeof(int));
+  collision_contact_t *contacts_prev = common_calloc(neighbours->n_partners_max, sizeof(collision_contact_t));
+  if(neighbours->is_built){
+    memcpy(offsets_prev, neighbours->offsets, sizeof(int)*(n_particles+1));
+    memcpy(partners_prev, neighbours->partners, sizeof(int)*n_partners_prev);
+    memcpy(contacts_prev, neighbours->contacts, sizeof(collision_contact_t)*n_partners_prev);
+  }
+  neighbours->n_partners = 0;
+  for(int n0 = n_min; n0 < n_max; n0++){
+    const particle_t *p = particles[n0];
+    neighbours->offsets[n0] = neighbours->n_partners;
+    int ix, iy;
+    find_cell(cells, ly, p->x+p->dx, p->y+p->dy, &ix, &iy);
+    // adjacent cells in y (periodic),
+    //   which are visited only once even when there are less than three cells
+    const int ncy = ncelly < 3 ? ncelly : 3;
+    for(int cy = 0; cy < ncy; cy++){
+      const int jy = ncelly < 3 ? cy : (iy-1+cy+ncelly)%ncelly;
+      // adjacent cells in x (wall-bounded)
+      const int jxmin = ix-1 <        0 ?        0 : ix-1;
+      const int jxmax = ix+1 > ncellx-1 ? ncellx-1 : ix+1;
+      for(int jx = jxmin; jx <= jxmax; jx++){
+        for(int n1 = heads[jy*ncellx+jx]; n1 != -1; n1 = nexts[n1]){
+          // each pair is considered only once
+          if(n1 <= n0){
+            continue;
+          }
+          if(are_close(ly, skin, p, particles[n1])){
+            // inherit the contact cache if this pair was listed previously
+            collision_contact_t contact = {.is_valid = false, .t0 = 0., .t1 = 0.};
+            for(int n = offsets_prev[n0]; n < offsets_prev[n0+1]; n++){
+              if(partners_prev[n] == n1){
+                contact = contacts_prev[n];
+                break;
+              }
+            }
+            append_partner(neighbours, n1, &contact);
+          }
+        }
+      }
+    }
+  }
+  neighbours->offsets[n_max] = neighbours->n_partners;
+  common_free(offsets_prev);
+  common_free(partners_prev);
+  common_free(contacts_prev);
+  // store current positions to judge the validity later
+  for(int n = 0; n < n_particles; n++){
+    const particle_t *p = particles[n];
+    neighbours->xs[n] = p->x+p->dx;
+    neighbours->ys[n] = p->y+p->dy;
+  }
+  neighbours->is_built = true;
+  return 0;
+}
+
+static int collide_cell_list(const param_t *param, const parallel_t *parallel, const int cnstep, suspensions_t *suspensions){
+  // check pairs in the neighbour list, which is updated only when it is outdated
+  particle_t **particles = suspensions->particles;
+  const geometry_t *geometries = suspensions->geometries;
+  collision_neighbours_t *neighbours = suspensions->collision_neighbours;
+  if(neighbours_are_outdated(param, suspensions)){
+    build_neighbours(param, parallel, suspensions);
+  }
+  int n_min, n_max;
+  get_my_particles(parallel, suspensions, &n_min, &n_max);
+  for(int n0 = n_min; n0 < n_max; n0++){
+    for(int n = neighbours->offsets[n0]; n < neighbours->offsets[n0+1]; n++){
+      const int n1 = neighbours->partners[n];
+      compute_collision_force_p_p(param, cnstep, particles[n0], particles[n1], geometries+n0, geometries+n1, neighbours->contacts+n);
+    }
+  }
+  return 0;
+}
+
 int suspensions_compute_collision_force(const param_t *param, const parallel_t *parallel, const int cnstep, suspensions_t *suspensions){
   /*
    * NOTE: only the spring in the normal direction is considered for simplicity
@@ -312,6 +638,7 @@ int suspensions_compute_collision_force(const param_t *param, const parallel_t *
   const double lx = param->lx;
   const int n_particles = suspensions->n_particles;
   particle_t **particles = suspensions->particles;
+  geometry_t *geometries = suspensions->geometries;
   // reset collision force at this CN step
   for(int n = 0; n < n_particles; n++){
     particle_t *p = particles[n];
@@ -319,16 +646,16 @@ int suspensions_compute_collision_force(const param_t *param, const parallel_t *
     p->cfy[cnstep] = 0.;
     p->ctz[cnstep] = 0.;
   }
+  // geometries at the current positions, shared by all pairs
+  for(int n = 0; n < n_particles; n++){
+    const particle_t *p = particles[n];
+    suspensions_compute_geometry(p, p->x+p->dx, p->y+p->dy, p->az, geometries+n);
+  }
   // particle-particle collisions
-  {
-    const int n_total = n_particles*(n_particles-1)/2;
-    int n_min, n_max;
-    get_my_range(parallel, n_total, &n_min, &n_max);
-    for(int n = n_min; n < n_max; n++){
-      int n0, n1;
-      get_particle_indices(n_particles, n, &n0, &n1);
-      compute_collision_force_p_p(param, cnstep, particles[n0], particles[n1]);
-    }
+  if(param->collision_cell_list){
+    collide_cell_list(param, parallel, cnstep, suspensions);
+  }else{
+    collide_all_pairs(param, parallel, cnstep, suspensions);
   }
   // particle-wall collisions
   {
@@ -336,9 +663,11 @@ int suspensions_compute_collision_force(const param_t *param, const parallel_t *
     for(int wall_index = 0; wall_index < 2; wall_index++){
       double wall_location = wall_locations[wall_index];
       int n_min, n_max;
-      get_my_range(parallel, n_particles, &n_min, &n_max);
+      get_my_particles(parallel, suspensions, &n_min, &n_max);
       for(int n = n_min; n < n_max; n++){
-        compute_collision_force_p_w(wall_location, cnstep, particles[n]);
+        // contact caches are used only with the neighbour list
+        collision_contact_t *contact = param->collision_cell_list ? suspensions->collision_neighbours->wall_contacts+2*n+wall_index : NULL;
+        compute_collision_force_p_w(wall_location, cnstep, particles[n], geometries+n, contact);
       }
     }
   }
@@ -353,8 +682,13 @@ int suspensions_compute_collision_force(const param_t *param, const parallel_t *
       buf[3*n+1] = p->cfy[cnstep];
       buf[3*n+2] = p->ctz[cnstep];
     }
-    // sum up all
-    MPI_Allreduce(MPI_IN_PLACE, buf, 3*n_particles, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    if(suspensions->ownership != NULL){
+      // owned particles have all contributions
+      suspensions_copy_to_ghosts(suspensions, 3, buf);
+    }else{
+      // sum up all
+      MPI_Allreduce(MPI_IN_PLACE, buf, 3*n_particles, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    }
     // unpack
     for(int n = 0; n < n_particles; n++){
       particle_t *p = particles[n];
@@ -22,11 +22,9 @@ static int kernel_exchange_momentum(const param_t *param, const parallel_t *para
   const double dt = param->dt;
   const double ly = param->ly;
   const double *xc = param->xc;
-  const double *yf = param->yf;
   const double *yc = param->yc;
   const double dx = param->dx;
   const double dy = param->dy;
-  const double grid_size = fmin(dx, dy);
   const double *ux = fluid->ux;
   const double *uy = fluid->uy;
   const int n_particles = suspensions->n_particles;
@@ -34,17 +32,26 @@ static int kernel_exchange_momentum(const param_t *param, const parallel_t *para
   double *duy = suspensions->duy;
   memset(dux, 0, DUX_MEMSIZE);
   memset(duy, 0, DUY_MEMSIZE);
+  // particles having no image in this process do not contribute
   for(int n = 0; n < n_particles; n++){
     particle_t *p = suspensions->particles[n];
-    // constant parameters
-    const double pden = p->den;
-    const double pa   = p->a;
-    const double pb   = p->b;
-    const double pm   = suspensions_compute_mass(pden, pa, pb);
-    const double pim  = suspensions_compute_moment_of_inertia(pden, pa, pb);
-    const double px   = p->x;
-    const double py   = p->y;
-    const double paz  = p->az;
+    p->fux = 0.;
+    p->fuy = 0.;
+    p->tvz = 0.;
+  }
+  // images intersecting this process
+  const image_list_t *list = suspensions->image_list;
+  suspensions_update_image_list(param, parallel, false, suspensions);
+  for(int e = 0; e < list->n_entries; ){
+    const int n = list->indices[e];
+    particle_t *p = suspensions->particles[n];
+    // geometry at the current position
+    geometry_t geometry;
+    suspensions_compute_geometry(p, p->x, p->y, p->az, &geometry);
+    const double pm   = geometry.mass;
+    const double pim  = geometry.moment_of_inertia;
+    const double px   = geometry.x;
+    const double py   = geometry.y;
     const double pux  = p->ux;
     const double puy  = p->uy;
     const double pvz  = p->vz;
@@ -52,16 +59,24 @@ static int kernel_exchange_momentum(const param_t *param, const parallel_t *para
     double fux = 0.;
     double fuy = 0.;
     double tvz = 0.;
-    for(int periodic = -1; periodic <= 1; periodic++){
+    // IBM weights at this position
+    stencil_t *stencil = suspensions->stencils+n;
+    suspensions_update_stencil(param, parallel, &geometry, stencil);
+    // from all images of this particle
+    for(; e < list->n_entries && list->indices[e] == n; e++){
+      const int periodic = list->periodics[e];
+      const stencil_image_t *image = stencil->images+periodic+1;
       double py_ = py+ly*periodic;
-      int imin, imax, jmin, jmax;
-      suspensions_decide_loop_size(1, itot,  dx, fmax(pa, pb), px,        &imin, &imax);
-      suspensions_decide_loop_size(1, jsize, dy, fmax(pa, pb), py_-YF(1), &jmin, &jmax);
+      const int jmin = image->jmin;
+      const int jmax = image->jmax;
       for(int j = jmin; j <= jmax; j++){
         double y = YC(j);
+        const int imin = image->imins[j-jmin];
+        const int imax = image->imaxs[j-jmin];
+        const double *weights = image->s_weights+image->offsets[j-jmin];
         for(int i = imin; i <= imax; i++){
           double x = XC(i);
-          double w = suspensions_s_weight(grid_size, pa, pb, px, py_, paz, x, y);
+          double w = weights[i-imin];
           double ux_p = pux-pvz*(y-py_);
           double uy_p = puy+pvz*(x-px);
           double ux_f = 0.5*(UX(i  , j  )+UX(i+1, j  ));
@@ -77,13 +92,15 @@ static int kernel_exchange_momentum(const param_t *param, const parallel_t *para
         }
       }
     }
-    fluid_update_boundaries_p(param, parallel, dux);
-    fluid_update_boundaries_p(param, parallel, duy);
     // assign results
     p->fux = fux;
     p->fuy = fuy;
     p->tvz = tvz;
   }
+  // stencils cover only the interior of this process, and thus halo cells are updated once
+  //   (numbers of particles differ among processes when they are distributed)
+  fluid_update_boundaries_p(param, parallel, dux);
+  fluid_update_boundaries_p(param, parallel, duy);
   return 0;
 }
 
@@ -100,7 +117,7 @@ static int synchronise_information(suspensions_t *suspensions){
     buf[3*n+2] = p->tvz;
   }
   // sum up all
-  MPI_Allreduce(MPI_IN_PLACE, buf, 3*n_particles, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  suspensions_sum_over_processes(suspensions, 3, buf);
   // unpack
   for(int n = 0; n < n_particles; n++){
     particle_t *p = particles[n];
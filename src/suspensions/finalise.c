@@ -14,6 +14,39 @@ int suspensions_finalise(suspensions_t *suspensions){
   common_free(suspensions->duy);
   // buffers to communicate Lagrange info
   common_free(suspensions->buf);
+  // IBM weights
+  for(int n = 0; n < n_particles; n++){
+    for(int periodic = 0; periodic < 3; periodic++){
+      common_free(suspensions->stencils[n].images[periodic].s_weights);
+      common_free(suspensions->stencils[n].images[periodic].v_weights);
+      common_free(suspensions->stencils[n].images[periodic].imins);
+      common_free(suspensions->stencils[n].images[periodic].imaxs);
+      common_free(suspensions->stencils[n].images[periodic].offsets);
+    }
+  }
+  common_free(suspensions->stencils);
+  common_free(suspensions->image_list->ys);
+  common_free(suspensions->image_list->indices);
+  common_free(suspensions->image_list->periodics);
+  common_free(suspensions->image_list);
+  common_free(suspensions->geometries);
+  // neighbour and cell lists for collisions
+  common_free(suspensions->collision_neighbours->xs);
+  common_free(suspensions->collision_neighbours->ys);
+  common_free(suspensions->collision_neighbours->offsets);
+  common_free(suspensions->collision_neighbours->partners);
+  common_free(suspensions->collision_neighbours->contacts);
+  common_free(suspensions->collision_neighbours->wall_contacts);
+  common_free(suspensions->collision_neighbours);
+  common_free(suspensions->collision_cells->heads);
+  common_free(suspensions->collision_cells->nexts);
+  common_free(suspensions->collision_cells);
+  // distribution among processes
+  if(suspensions->ownership != NULL){
+    common_free(suspensions->ownership->sends[0]);
+    common_free(suspensions->ownership->sends[1]);
+    common_free(suspensions->ownership);
+  }
   // main structure
   common_free(suspensions);
   return 0;
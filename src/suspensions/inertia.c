@@ -10,48 +10,58 @@ static int compute_inertia(const param_t *param, const parallel_t *parallel, con
   // \int ux dV
   // \int uy dV
   // \int ( - ry ux + rx uy ) dV
-  const int mpisize = parallel->mpisize;
-  const int mpirank = parallel->mpirank;
   const int itot = param->itot;
-  const int jtot = param->jtot;
-  const int jsize = parallel_get_size(jtot, mpisize, mpirank);
   const double ly = param->ly;
   const double *xc = param->xc;
-  const double *yf = param->yf;
   const double *yc = param->yc;
   const double dx = param->dx;
   const double dy = param->dy;
-  const double grid_size = fmin(dx, dy);
   const double *ux = fluid->ux;
   const double *uy = fluid->uy;
   const int n_particles = suspensions->n_particles;
   particle_t **particles = suspensions->particles;
+  // particles having no image in this process do not contribute
   for(int n = 0; n < n_particles; n++){
     particle_t *p = particles[n];
-    // constant parameters
-    const double pden = p->den;
-    const double pa   = p->a;
-    const double pb   = p->b;
-    const double px   = p->x+p->dx;
-    const double py   = p->y+p->dy;
-    const double paz  = p->az+p->daz;
-    const double pm   = suspensions_compute_mass(pden, pa, pb);
-    const double pim  = suspensions_compute_moment_of_inertia(pden, pa, pb);
+    p->iux[cnstep] = 0.;
+    p->iuy[cnstep] = 0.;
+    p->ivz[cnstep] = 0.;
+  }
+  // images intersecting this process
+  const image_list_t *list = suspensions->image_list;
+  suspensions_update_image_list(param, parallel, true, suspensions);
+  for(int e = 0; e < list->n_entries; ){
+    const int n = list->indices[e];
+    particle_t *p = particles[n];
+    // geometry at the current position
+    geometry_t geometry;
+    suspensions_compute_geometry(p, p->x+p->dx, p->y+p->dy, p->az+p->daz, &geometry);
+    const double px  = geometry.x;
+    const double py  = geometry.y;
+    const double pm  = geometry.mass;
+    const double pim = geometry.moment_of_inertia;
     // buffers (for simplicity)
     double iux = 0.;
     double iuy = 0.;
     double ivz = 0.;
-    // ux contribution
-    for(int periodic = -1; periodic <= 1; periodic++){
+    // IBM weights at this position
+    stencil_t *stencil = suspensions->stencils+n;
+    suspensions_update_stencil(param, parallel, &geometry, stencil);
+    // ux contribution, from all images of this particle
+    for(; e < list->n_entries && list->indices[e] == n; e++){
+      const int periodic = list->periodics[e];
+      const stencil_image_t *image = stencil->images+periodic+1;
       double py_ = py+ly*periodic;
-      int imin, imax, jmin, jmax;
-      suspensions_decide_loop_size(1, itot,  dx, fmax(pa, pb), px,        &imin, &imax);
-      suspensions_decide_loop_size(1, jsize, dy, fmax(pa, pb), py_-YF(1), &jmin, &jmax);
+      const int jmin = image->jmin;
+      const int jmax = image->jmax;
       for(int j = jmin; j <= jmax; j++){
         double y = YC(j);
+        const int imin = image->imins[j-jmin];
+        const int imax = image->imaxs[j-jmin];
+        const double *weights = image->v_weights+image->offsets[j-jmin];
         for(int i = imin; i <= imax; i++){
           double x = XC(i);
-          double w = suspensions_v_weight(grid_size, pa, pb, px, py_, paz, x, y);
+          double w = weights[i-imin];
           double valx = w*0.5*(UX(i  , j  )+UX(i+1, j  ))*(dx*dy);
           double valy = w*0.5*(UY(i  , j  )+UY(i  , j+1))*(dx*dy);
           iux += valx/pm;
@@ -82,7 +92,7 @@ static int synchronise_information(const int cnstep, suspensions_t *suspensions)
     buf[3*n+2] = p->ivz[cnstep];
   }
   // sum up all
-  MPI_Allreduce(MPI_IN_PLACE, buf, 3*n_particles, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  suspensions_sum_over_processes(suspensions, 3, buf);
   // unpack
   for(int n = 0; n < n_particles; n++){
     particle_t *p = particles[n];
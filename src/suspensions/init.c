@@ -1,3 +1,4 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -35,6 +36,7 @@ static int init_or_load(const param_t *param, suspensions_t *suspensions){
     strcpy(dirname, dirname_init_particles);
   }
   fileio_r_0d_serial(dirname, "n_particles", sizeof(int), &n_particles);
+  suspensions->n_particles_total = n_particles;
   suspensions->n_particles = n_particles;
   // particles
   suspensions->particles = common_calloc(n_particles, sizeof(particle_t*));
@@ -62,6 +64,7 @@ static int init_or_load(const param_t *param, suspensions_t *suspensions){
   fileio_r_1d_serial(dirname, "particle_vzs",  sizeof(double), n_particles,  vzs);
   for(int n = 0; n < n_particles; n++){
     particle_t *p = suspensions->particles[n];
+    p->id  = n;
     p->den = dens[n];
     p->a   = as[n];
     p->b   = bs[n];
@@ -85,12 +88,106 @@ static int init_or_load(const param_t *param, suspensions_t *suspensions){
   return 0;
 }
 
+static collision_neighbours_t *init_collision_neighbours(const param_t *param, const suspensions_t *suspensions){
+  const int n_particles = suspensions->n_particles;
+  collision_neighbours_t *neighbours = common_calloc(1, sizeof(collision_neighbours_t));
+  // built when it is used for the first time
+  neighbours->is_built = false;
+  neighbours->skin = param->collision_skin*fmin(param->dx, param->dy);
+  neighbours->xs = common_calloc(n_particles, sizeof(double));
+  neighbours->ys = common_calloc(n_particles, sizeof(double));
+  neighbours->offsets = common_calloc(n_particles+1, sizeof(int));
+  // extended when needed
+  neighbours->n_partners = 0;
+  neighbours->n_partners_max = n_particles;
+  neighbours->partners = common_calloc(neighbours->n_partners_max, sizeof(int));
+  // invalid (zero-cleared) until contacts are found
+  neighbours->contacts = common_calloc(neighbours->n_partners_max, sizeof(collision_contact_t));
+  neighbours->wall_contacts = common_calloc(2*n_particles, sizeof(collision_contact_t));
+  return neighbours;
+}
+
+static collision_cells_t *init_collision_cells(const param_t *param, const suspensions_t *suspensions){
+  const double lx = param->lx;
+  const double ly = param->ly;
+  const int n_particles = suspensions->n_particles;
+  collision_cells_t *cells = common_calloc(1, sizeof(collision_cells_t));
+  // largest diameter among all particles plus skin
+  double dmax = 0.;
+  for(int n = 0; n < n_particles; n++){
+    const particle_t *p = suspensions->particles[n];
+    dmax = fmax(dmax, 2.*fmax(p->a, p->b));
+  }
+  dmax += suspensions->collision_neighbours->skin;
+  // at least one cell in each direction
+  cells->ncellx = dmax > 0. ? (int)fmax(1., floor(lx/dmax)) : 1;
+  cells->ncelly = dmax > 0. ? (int)fmax(1., floor(ly/dmax)) : 1;
+  cells->cellsizex = lx/cells->ncellx;
+  cells->cellsizey = ly/cells->ncelly;
+  cells->heads = common_calloc(cells->ncellx*cells->ncelly, sizeof(int));
+  cells->nexts = common_calloc(n_particles, sizeof(int));
+  return cells;
+}
+
+static ownership_t *init_ownership(const param_t *param, const parallel_t *parallel, const suspensions_t *suspensions){
+  const int mpisize = parallel->mpisize;
+  const int jtot = param->jtot;
+  const double dy = param->dy;
+  const int n_particles = suspensions->n_particles;
+  // largest radius among all particles
+  double rmax = 0.;
+  for(int n = 0; n < n_particles; n++){
+    const particle_t *p = suspensions->particles[n];
+    rmax = fmax(rmax, fmax(p->a, p->b));
+  }
+  // collision partners (closer than the skin) and stencils (a few cells beyond the surfaces)
+  //   should be available as ghosts, with margins for displacements in a time step
+  const double reach = 2.*rmax+suspensions->collision_neighbours->skin+5.*dy;
+  // ghosts are exchanged only with the adjacent processes,
+  //   which requires all slabs to be thicker than the reach
+  const double thickness = dy*(jtot/mpisize);
+  if(thickness < reach){
+    if(parallel->mpirank == 0){
+      printf("particle_ownership is ignored: slabs (%.2e) are thinner than the reach (%.2e)\n", thickness, reach);
+    }
+    return NULL;
+  }
+  ownership_t *ownership = common_calloc(1, sizeof(ownership_t));
+  ownership->reach = reach;
+  // all particles are owned until they are distributed
+  ownership->n_owned = n_particles;
+  ownership->n_neighbours = mpisize == 1 ? 0 : mpisize == 2 ? 1 : 2;
+  ownership->neighbours[0] = parallel->ymrank;
+  ownership->neighbours[1] = parallel->yprank;
+  ownership->ghost_offsets[0] = n_particles;
+  ownership->ghost_offsets[1] = n_particles;
+  ownership->ghost_offsets[2] = n_particles;
+  return ownership;
+}
+
 suspensions_t *suspensions_init(const param_t *param, const parallel_t *parallel){
   suspensions_t *suspensions = NULL;
   allocate(param, parallel, &suspensions);
   init_or_load(param, suspensions);
   // buffers to communicate Lagrange info
   suspensions->buf = common_calloc(3*suspensions->n_particles, sizeof(double));
+  // IBM weights, computed when they are used for the first time
+  suspensions->stencils = common_calloc(suspensions->n_particles, sizeof(stencil_t));
+  // images of particles, built when they are used for the first time
+  suspensions->image_list = common_calloc(1, sizeof(image_list_t));
+  suspensions->image_list->is_built = false;
+  suspensions->image_list->ys = common_calloc(suspensions->n_particles, sizeof(double));
+  suspensions->image_list->n_entries = 0;
+  suspensions->image_list->indices = common_calloc(3*suspensions->n_particles, sizeof(int));
+  suspensions->image_list->periodics = common_calloc(3*suspensions->n_particles, sizeof(int));
+  // buffer to store geometries of particles
+  suspensions->geometries = common_calloc(suspensions->n_particles, sizeof(geometry_t));
+  // neighbour and cell lists for collisions
+  suspensions->collision_neighbours = init_collision_neighbours(param, suspensions);
+  suspensions->collision_cells = init_collision_cells(param, suspensions);
+  // keep own particles and ghosts only
+  suspensions->ownership = param->particle_ownership ? init_ownership(param, parallel, suspensions) : NULL;
+  suspensions_migrate_particles(param, parallel, suspensions);
   return suspensions;
 }
 
@@ -0,0 +1,277 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include <mpi.h>
+#include "common.h"
+#include "param.h"
+#include "parallel.h"
+#include "suspensions.h"
+
+
+static int get_slab(const param_t *param, const parallel_t *parallel, const int rank, double *ymin, double *ymax){
+  // range in y covered by the given process,
+  //   the first and the last ones are extended to the domain edges to cover [0 : ly) exactly
+  const int mpisize = parallel->mpisize;
+  const int jtot = param->jtot;
+  const double ly = param->ly;
+  const double dy = param->dy;
+  const int joffset = parallel_get_offset(jtot, mpisize, rank);
+  const int jsize = parallel_get_size(jtot, mpisize, rank);
+  *ymin = rank ==         0 ? 0. : dy*joffset;
+  *ymax = rank == mpisize-1 ? ly : dy*(joffset+jsize);
+  return 0;
+}
+
+static double wrap(const double ly, const double y){
+  double y_ = fmod(y, ly);
+  return y_ < 0. ? y_+ly : y_;
+}
+
+static double distance_to_slab(const double ly, const double y, const double ymin, const double ymax){
+  // distance from y to [ymin : ymax), N.B. periodicity in y
+  const double y_ = wrap(ly, y);
+  if(ymin <= y_ && y_ < ymax){
+    return 0.;
+  }
+  const double d0 = wrap(ly, ymin-y_);
+  const double d1 = wrap(ly, y_-ymax);
+  return fmin(d0, d1);
+}
+
+static int compare_ids(const void *p0, const void *p1){
+  const int id0 = (*(particle_t * const *)p0)->id;
+  const int id1 = (*(particle_t * const *)p1)->id;
+  return (id0 > id1) - (id0 < id1);
+}
+
+static int reallocate_buffers(suspensions_t *suspensions, const int n_particles_prev){
+  // buffers whose sizes are proportional to the number of particles,
+  //   caches in them are discarded since indices of particles are changed
+  const int n_particles = suspensions->n_particles;
+  common_free(suspensions->buf);
+  suspensions->buf = common_calloc(3*n_particles, sizeof(double));
+  for(int n = 0; n < n_particles_prev; n++){
+    for(int periodic = 0; periodic < 3; periodic++){
+      common_free(suspensions->stencils[n].images[periodic].s_weights);
+      common_free(suspensions->stencils[n].images[periodic].v_weights);
+      common_free(suspensions->stencils[n].images[periodic].imins);
+      common_free(suspensions->stencils[n].images[periodic].imaxs);
+      common_free(suspensions->stencils[n].images[periodic].offsets);
+    }
+  }
+  common_free(suspensions->stencils);
+  suspensions->stencils = common_calloc(n_particles, sizeof(stencil_t));
+  image_list_t *list = suspensions->image_list;
+  common_free(list->ys);
+  common_free(list->indices);
+  common_free(list->periodics);
+  list->is_built = false;
+  list->n_entries = 0;
+  list->ys = common_calloc(n_particles, sizeof(double));
+  list->indices = common_calloc(3*n_particles, sizeof(int));
+  list->periodics = common_calloc(3*n_particles, sizeof(int));
+  common_free(suspensions->geometries);
+  suspensions->geometries = common_calloc(n_particles, sizeof(geometry_t));
+  collision_neighbours_t *neighbours = suspensions->collision_neighbours;
+  common_free(neighbours->xs);
+  common_free(neighbours->ys);
+  common_free(neighbours->offsets);
+  common_free(neighbours->wall_contacts);
+  neighbours->is_built = false;
+  neighbours->n_partners = 0;
+  neighbours->xs = common_calloc(n_particles, sizeof(double));
+  neighbours->ys = common_calloc(n_particles, sizeof(double));
+  neighbours->offsets = common_calloc(n_particles+1, sizeof(int));
+  neighbours->wall_contacts = common_calloc(2*n_particles, sizeof(collision_contact_t));
+  collision_cells_t *cells = suspensions->collision_cells;
+  common_free(cells->nexts);
+  cells->nexts = common_calloc(n_particles, sizeof(int));
+  return 0;
+}
+
+int suspensions_migrate_particles(const param_t *param, const parallel_t *parallel, suspensions_t *suspensions){
+  // particles whose centers are in this slab are owned,
+  //   and owned particles within the reach of the neighbours are sent to them as ghosts
+  // since particles move less than the reach in a time step,
+  //   particles coming from the neighbours are already stored as ghosts
+  ownership_t *ownership = suspensions->ownership;
+  if(ownership == NULL){
+    return 0;
+  }
+  const int mpirank = parallel->mpirank;
+  const double ly = param->ly;
+  const int n_particles = suspensions->n_particles;
+  particle_t **particles = suspensions->particles;
+  // find owned particles, sorted by ids to fix the order of summations
+  double ymin, ymax;
+  get_slab(param, parallel, mpirank, &ymin, &ymax);
+  int n_owned = 0;
+  particle_t **owned = common_calloc(n_particles, sizeof(particle_t*));
+  bool *is_owned = common_calloc(n_particles, sizeof(bool));
+  for(int n = 0; n < n_particles; n++){
+    particle_t *p = particles[n];
+    const double y = wrap(ly, p->y);
+    if(ymin <= y && y < ymax){
+      owned[n_owned] = p;
+      is_owned[n] = true;
+      n_owned += 1;
+    }
+  }
+  qsort(owned, n_owned, sizeof(particle_t*), compare_ids);
+  // all particles should be owned by one of the processes
+  {
+    int n_owned_total = n_owned;
+    MPI_Allreduce(MPI_IN_PLACE, &n_owned_total, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if(n_owned_total != suspensions->n_particles_total){
+      if(mpirank == 0){
+        fprintf(stderr, "particles are lost during migration (%d / %d)\n", n_owned_total, suspensions->n_particles_total);
+      }
+      MPI_Abort(MPI_COMM_WORLD, 0);
+    }
+  }
+  // owned particles within the reach of each neighbour
+  const int n_neighbours = ownership->n_neighbours;
+  for(int k = 0; k < n_neighbours; k++){
+    double ymin_, ymax_;
+    get_slab(param, parallel, ownership->neighbours[k], &ymin_, &ymax_);
+    common_free(ownership->sends[k]);
+    ownership->sends[k] = common_calloc(n_owned, sizeof(int));
+    ownership->n_sends[k] = 0;
+    for(int m = 0; m < n_owned; m++){
+      if(distance_to_slab(ly, owned[m]->y, ymin_, ymax_) <= ownership->reach){
+        ownership->sends[k][ownership->n_sends[k]] = m;
+        ownership->n_sends[k] += 1;
+      }
+    }
+  }
+  // exchange numbers of ghosts and then particles themselves
+  int n_recvs[2] = {0, 0};
+  particle_t *sendbufs[2] = {NULL, NULL};
+  particle_t *recvbufs[2] = {NULL, NULL};
+  {
+    MPI_Request requests[4];
+    for(int k = 0; k < n_neighbours; k++){
+      MPI_Irecv(n_recvs+k,             1, MPI_INT, ownership->neighbours[k], 0, MPI_COMM_WORLD, requests+2*k+0);
+      MPI_Isend(ownership->n_sends+k, 1, MPI_INT, ownership->neighbours[k], 0, MPI_COMM_WORLD, requests+2*k+1);
+    }
+    MPI_Waitall(2*n_neighbours, requests, MPI_STATUSES_IGNORE);
+    for(int k = 0; k < n_neighbours; k++){
+      sendbufs[k] = common_calloc(ownership->n_sends[k], sizeof(particle_t));
+      recvbufs[k] = common_calloc(n_recvs[k], sizeof(particle_t));
+      for(int m = 0; m < ownership->n_sends[k]; m++){
+        sendbufs[k][m] = *owned[ownership->sends[k][m]];
+      }
+      MPI_Irecv(recvbufs[k], n_recvs[k]*sizeof(particle_t),             MPI_BYTE, ownership->neighbours[k], 0, MPI_COMM_WORLD, requests+2*k+0);
+      MPI_Isend(sendbufs[k], ownership->n_sends[k]*sizeof(particle_t), MPI_BYTE, ownership->neighbours[k], 0, MPI_COMM_WORLD, requests+2*k+1);
+    }
+    MPI_Waitall(2*n_neighbours, requests, MPI_STATUSES_IGNORE);
+  }
+  // new list: owned particles followed by ghosts from each neighbour
+  ownership->ghost_offsets[0] = n_owned;
+  for(int k = 0; k < 2; k++){
+    ownership->ghost_offsets[k+1] = ownership->ghost_offsets[k]+(k < n_neighbours ? n_recvs[k] : 0);
+  }
+  const int n_particles_new = ownership->ghost_offsets[2];
+  particle_t **particles_new = common_calloc(n_particles_new, sizeof(particle_t*));
+  for(int m = 0; m < n_owned; m++){
+    particles_new[m] = owned[m];
+  }
+  for(int k = 0; k < n_neighbours; k++){
+    for(int m = 0; m < n_recvs[k]; m++){
+      particle_t *p = common_calloc(1, sizeof(particle_t));
+      *p = recvbufs[k][m];
+      particles_new[ownership->ghost_offsets[k]+m] = p;
+    }
+    common_free(sendbufs[k]);
+    common_free(recvbufs[k]);
+  }
+  // caches indexed by particles are kept as long as the list is unchanged
+  bool is_changed = n_particles_new != n_particles;
+  for(int n = 0; !is_changed && n < n_particles; n++){
+    is_changed = particles_new[n]->id != particles[n]->id;
+  }
+  // particles which are not owned (old ghosts and the ones moved to the neighbours) are replaced
+  for(int n = 0; n < n_particles; n++){
+    if(!is_owned[n]){
+      common_free(particles[n]);
+    }
+  }
+  common_free(particles);
+  common_free(owned);
+  common_free(is_owned);
+  suspensions->particles = particles_new;
+  suspensions->n_particles = n_particles_new;
+  ownership->n_owned = n_owned;
+  if(is_changed){
+    reallocate_buffers(suspensions, n_particles);
+  }
+  return 0;
+}
+
+int suspensions_copy_to_ghosts(const suspensions_t *suspensions, const int n_items, double *buf){
+  // buf[n_items*n : n_items*(n+1)-1] of the ghosts are overwritten by the values of the owners
+  const ownership_t *ownership = suspensions->ownership;
+  const int n_neighbours = ownership->n_neighbours;
+  double *sendbufs[2] = {NULL, NULL};
+  MPI_Request requests[4];
+  for(int k = 0; k < n_neighbours; k++){
+    const int n_sends = ownership->n_sends[k];
+    const int n_recvs = ownership->ghost_offsets[k+1]-ownership->ghost_offsets[k];
+    sendbufs[k] = common_calloc(n_items*n_sends, sizeof(double));
+    for(int m = 0; m < n_sends; m++){
+      for(int c = 0; c < n_items; c++){
+        sendbufs[k][n_items*m+c] = buf[n_items*ownership->sends[k][m]+c];
+      }
+    }
+    MPI_Irecv(buf+n_items*ownership->ghost_offsets[k], n_items*n_recvs, MPI_DOUBLE, ownership->neighbours[k], 0, MPI_COMM_WORLD, requests+2*k+0);
+    MPI_Isend(sendbufs[k],                            n_items*n_sends, MPI_DOUBLE, ownership->neighbours[k], 0, MPI_COMM_WORLD, requests+2*k+1);
+  }
+  MPI_Waitall(2*n_neighbours, requests, MPI_STATUSES_IGNORE);
+  for(int k = 0; k < n_neighbours; k++){
+    common_free(sendbufs[k]);
+  }
+  return 0;
+}
+
+int suspensions_sum_over_processes(const suspensions_t *suspensions, const int n_items, double *buf){
+  // partial sums of particles computed by each process, buf[n_items*n : n_items*(n+1)-1],
+  //   are summed up and shared by all processes having the particle
+  const ownership_t *ownership = suspensions->ownership;
+  if(ownership == NULL){
+    MPI_Allreduce(MPI_IN_PLACE, buf, n_items*suspensions->n_particles, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    return 0;
+  }
+  // partial sums of the ghosts are sent to the owners
+  const int n_neighbours = ownership->n_neighbours;
+  double *recvbufs[2] = {NULL, NULL};
+  MPI_Request requests[4];
+  for(int k = 0; k < n_neighbours; k++){
+    const int n_sends = ownership->ghost_offsets[k+1]-ownership->ghost_offsets[k];
+    const int n_recvs = ownership->n_sends[k];
+    recvbufs[k] = common_calloc(n_items*n_recvs, sizeof(double));
+    MPI_Irecv(recvbufs[k],                            n_items*n_recvs, MPI_DOUBLE, ownership->neighbours[k], 0, MPI_COMM_WORLD, requests+2*k+0);
+    MPI_Isend(buf+n_items*ownership->ghost_offsets[k], n_items*n_sends, MPI_DOUBLE, ownership->neighbours[k], 0, MPI_COMM_WORLD, requests+2*k+1);
+  }
+  MPI_Waitall(2*n_neighbours, requests, MPI_STATUSES_IGNORE);
+  for(int k = 0; k < n_neighbours; k++){
+    for(int m = 0; m < ownership->n_sends[k]; m++){
+      for(int c = 0; c < n_items; c++){
+        buf[n_items*ownership->sends[k][m]+c] += recvbufs[k][n_items*m+c];
+      }
+    }
+    common_free(recvbufs[k]);
+  }
+  // totals are sent back to the ghosts
+  suspensions_copy_to_ghosts(suspensions, n_items, buf);
+  return 0;
+}
+
+bool suspensions_is_owner(const parallel_t *parallel, const suspensions_t *suspensions, const int n){
+  // all particles are handled by the main process when they are not distributed
+  if(suspensions->ownership == NULL){
+    return parallel->mpirank == 0;
+  }
+  return n < suspensions->ownership->n_owned;
+}
+
@@ -0,0 +1,123 @@
+#include <math.h>
+#include "common.h"
+#include "param.h"
+#include "parallel.h"
+#include "suspensions.h"
+
+
+int suspensions_update_stencil(const param_t *param, const parallel_t *parallel, const geometry_t *geometry, stencil_t *stencil){
+  // nothing to do when the particle has not moved since the last call
+  if(stencil->is_built && stencil->geometry.x == geometry->x && stencil->geometry.y == geometry->y && stencil->geometry.az == geometry->az){
+    return 0;
+  }
+  const int mpisize = parallel->mpisize;
+  const int mpirank = parallel->mpirank;
+  const int itot = param->itot;
+  const int jtot = param->jtot;
+  const int jsize = parallel_get_size(jtot, mpisize, mpirank);
+  const double ly = param->ly;
+  const double *xc = param->xc;
+  const double *yf = param->yf;
+  const double *yc = param->yc;
+  const double dx = param->dx;
+  const double dy = param->dy;
+  const double grid_size = fmin(dx, dy);
+  // points farther than the band are excluded from each row
+  const double band = param->ibm_band_width*grid_size;
+  for(int periodic = -1; periodic <= 1; periodic++){
+    stencil_image_t *image = stencil->images+periodic+1;
+    // geometry of this periodic image
+    geometry_t geometry_ = *geometry;
+    geometry_.y += ly*periodic;
+    int imin, imax;
+    suspensions_decide_loop_size(1, itot,  dx, geometry_.radius, geometry_.x,        &imin, &imax);
+    suspensions_decide_loop_size(1, jsize, dy, geometry_.radius, geometry_.y-YF(1), &image->jmin, &image->jmax);
+    const int isize = imax-imin+1;
+    const int jsize_ = image->jmax-image->jmin+1;
+    // no grid point when the image is out of this process
+    if(isize <= 0 || jsize_ <= 0){
+      image->jmax = image->jmin-1;
+      continue;
+    }
+    // extend buffers, which are large enough to store the whole box
+    if(jsize_ > image->row_capacity){
+      common_free(image->imins);
+      common_free(image->imaxs);
+      common_free(image->offsets);
+      image->row_capacity = jsize_;
+      image->imins = common_calloc(image->row_capacity, sizeof(int));
+      image->imaxs = common_calloc(image->row_capacity, sizeof(int));
+      image->offsets = common_calloc(image->row_capacity, sizeof(int));
+    }
+    if(isize*jsize_ > image->capacity){
+      common_free(image->s_weights);
+      common_free(image->v_weights);
+      image->capacity = isize*jsize_;
+      image->s_weights = common_calloc(image->capacity, sizeof(double));
+      image->v_weights = common_calloc(image->capacity, sizeof(double));
+    }
+    int offset = 0;
+    for(int j = image->jmin; j <= image->jmax; j++){
+      int *imin_ = image->imins+j-image->jmin;
+      int *imax_ = image->imaxs+j-image->jmin;
+      suspensions_decide_row_size(imin, imax, dx, band, &geometry_, YC(j), imin_, imax_);
+      const int n = *imax_-*imin_+1 > 0 ? *imax_-*imin_+1 : 0;
+      image->offsets[j-image->jmin] = offset;
+      if(n > 0){
+        suspensions_compute_weights(grid_size, param->ibm_band_width, &geometry_, YC(j), n, &XC(*imin_), image->s_weights+offset, image->v_weights+offset);
+      }
+      offset += n;
+    }
+  }
+  stencil->is_built = true;
+  stencil->geometry = *geometry;
+  return 0;
+}
+
+int suspensions_update_image_list(const param_t *param, const parallel_t *parallel, const bool with_increments, const suspensions_t *suspensions){
+  // positions in y are p->y+p->dy (with_increments) or p->y
+  const int mpisize = parallel->mpisize;
+  const int mpirank = parallel->mpirank;
+  const int jtot = param->jtot;
+  const int jsize = parallel_get_size(jtot, mpisize, mpirank);
+  const double ly = param->ly;
+  const double *yf = param->yf;
+  const double dy = param->dy;
+  const int n_particles = suspensions->n_particles;
+  particle_t **particles = suspensions->particles;
+  image_list_t *list = suspensions->image_list;
+  // nothing to do when no particle has moved in y since the last call
+  if(list->is_built){
+    bool is_moved = false;
+    for(int n = 0; n < n_particles; n++){
+      const particle_t *p = particles[n];
+      const double py = with_increments ? p->y+p->dy : p->y;
+      if(list->ys[n] != py){
+        is_moved = true;
+        break;
+      }
+    }
+    if(!is_moved){
+      return 0;
+    }
+  }
+  list->n_entries = 0;
+  for(int n = 0; n < n_particles; n++){
+    const particle_t *p = particles[n];
+    const double py = with_increments ? p->y+p->dy : p->y;
+    for(int periodic = -1; periodic <= 1; periodic++){
+      // same range as the stencil, which is empty when the image is out of this process
+      int jmin, jmax;
+      suspensions_decide_loop_size(1, jsize, dy, fmax(p->a, p->b), py+ly*periodic-YF(1), &jmin, &jmax);
+      if(jmin <= jmax){
+        list->indices[list->n_entries] = n;
+        list->periodics[list->n_entries] = periodic;
+        list->n_entries += 1;
+      }
+    }
+    list->ys[n] = py;
+  }
+  list->is_built = true;
+  return 0;
+}
+